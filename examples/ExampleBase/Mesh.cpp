@@ -105,8 +105,6 @@ namespace vkx {
 			Mesh * mesh;
 			std::vector<float> verticies;
 			std::vector<uint32_t> indicies;
-			vkw::SubBuffer vertStagingSubBuffer;
-			vkw::SubBuffer indStagingSubBuffer;
 		};
 		std::vector<BufferLoadInfo> bufferLoadInfos(loadInfos.size());
 
@@ -149,30 +147,26 @@ namespace vkx {
 			allocations.emplace_back(allocInfo);
 		}
 
-		vkw::Memory stagingMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-		vkw::Buffer stagingBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, totalVertSize + totalIndSize);
-		stagingMemory.allocateMemory({ stagingBuffer });
+		// every mesh is uploaded with one submit
+		// both uploads of a mesh may be padded to the belt's alignment, reserving the last one needs alignment bytes of headroom
+		const VkDeviceSize uploadAlignment = vkw::StagingBelt::bufferUploadAlignment;
+		vkw::StagingBelt stagingBelt(totalVertSize + totalIndSize + 2 * bufferLoadInfos.size() * (uploadAlignment - 1) + uploadAlignment);
 
 
 
 		// load into buffers
 		for (auto & x : bufferLoadInfos) {
 			Mesh & mesh = *x.mesh;
-			x.vertStagingSubBuffer = stagingBuffer.createSubBuffer(mesh.verticiesSize());
-			x.vertStagingSubBuffer.write(x.verticies.data(), mesh.verticiesSize());
-
-			x.indStagingSubBuffer = stagingBuffer.createSubBuffer(mesh.indiciesSize());
-			x.indStagingSubBuffer.write(x.indicies.data(), mesh.indiciesSize());
-
 			mesh.vertexBuffer = vertexBuffers.back().createSubBuffer(mesh.verticiesSize());
-			mesh.vertexBuffer.copyFrom(x.vertStagingSubBuffer);
+			stagingBelt.upload(mesh.vertexBuffer, x.verticies.data(), mesh.verticiesSize());
 
 			mesh.indexBuffer = indexBuffers.back().createSubBuffer(mesh.indiciesSize());
-			mesh.indexBuffer.copyFrom(x.indStagingSubBuffer);
-
-			x.indStagingSubBuffer.clear();
-			x.vertStagingSubBuffer.clear();
+			stagingBelt.upload(mesh.indexBuffer, x.indicies.data(), mesh.indiciesSize());
 		}
+
+		stagingBelt.submit();
+		stagingBelt.wait();
+		stagingBelt.submitAcquire().wait(); // no-op if transfer and graphics queue share a family
 	}
 
 	void MeshLoader::loadMeshDataIntoMemory(const aiScene * pScene, std::vector<float>& verticies, std::vector<uint32_t> & indicies, const Mesh::LoadInfo & meshloadInfo)
@@ -56,7 +56,6 @@ namespace vkx {
 		
 		image.createImage(imageCreateInfo);
 		memory.allocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, {}, { image });
-		image.transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
 
 
 
@@ -104,8 +103,13 @@ namespace vkx {
 			bufferCopyRegions.push_back(bufferCopyRegion);
 		}
 
-		image.copyFromBuffer(stagingBuffer, bufferCopyRegions);
-		image.transitionImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+		// transitions and copy in one submit
+		vkw::TransferBatch transferBatch;
+		transferBatch.transitionBeforeCopies(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		transferBatch.copyBufferToImage(stagingBuffer, image, bufferCopyRegions);
+		transferBatch.transitionAfterCopies(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		transferBatch.submit().wait();
+		transferBatch.submitAcquire().wait(); // no-op if transfer and graphics queue share a family
 
 
 		// setup sampler and image view
@@ -182,7 +186,6 @@ namespace vkx {
 		}
 
 		image.createImage(imageCreateInfo);
-		image.transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
 		memory.allocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, {}, { image });
 
 		vkw::Memory stagingMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
@@ -190,7 +193,13 @@ namespace vkx {
 		stagingMemory.allocateMemory({ stagingBuffer });
 		stagingBuffer.write(texCube.data(), texCube.size());
 
-		image.copyFromBuffer(stagingBuffer, bufferCopyRegions);
+		// transitions and copy in one submit
+		vkw::TransferBatch transferBatch;
+		transferBatch.transitionBeforeCopies(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		transferBatch.copyBufferToImage(stagingBuffer, image, bufferCopyRegions);
+		transferBatch.transitionAfterCopies(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		transferBatch.submit().wait();
+		transferBatch.submitAcquire().wait(); // no-op if transfer and graphics queue share a family
 
 
 		// setup sampler and image view
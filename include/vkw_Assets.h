@@ -18,12 +18,15 @@ namespace vkw {
 		VULKAN_WRAPPER_API Swapchain();
 		VULKAN_WRAPPER_API Swapchain(Surface & surface);
 		VULKAN_WRAPPER_API Swapchain(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API Swapchain(const Swapchain & rhs);
+		VULKAN_WRAPPER_API Swapchain(Swapchain && rhs) noexcept;
 		VULKAN_WRAPPER_API ~Swapchain();
 
 		VULKAN_WRAPPER_API void createSwapchain(Surface & surface);
 		VULKAN_WRAPPER_API void createSwapchain(const CreateInfo & createInfo);
 
 		VULKAN_WRAPPER_API Swapchain & operator = (const Swapchain & rhs);
+		VULKAN_WRAPPER_API Swapchain & operator = (Swapchain && rhs) noexcept;
 
 		VULKAN_WRAPPER_API uint32_t getNextImage(VkSemaphore semaphore = VK_NULL_HANDLE, VkFence fence = VK_NULL_HANDLE);
 		VULKAN_WRAPPER_API void presentImage(uint32_t imageIndex, std::vector<VkSemaphore> semaphores);
@@ -60,6 +63,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API Semaphore(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API Semaphore(VkSemaphoreCreateFlags flags);
 		VULKAN_WRAPPER_API ~Semaphore() = default;
+		VULKAN_WRAPPER_API Semaphore(const Semaphore & rhs) = default;
+		VULKAN_WRAPPER_API Semaphore(Semaphore && rhs) = default;
+		VULKAN_WRAPPER_API Semaphore & operator = (const Semaphore & rhs) = default;
+		VULKAN_WRAPPER_API Semaphore & operator = (Semaphore && rhs) = default;
 
 		VULKAN_WRAPPER_API void createSemaphore(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createSemaphore(VkSemaphoreCreateFlags flags = 0);
@@ -69,6 +76,41 @@ namespace vkw {
 
 
 
+	/// Timeline Semaphore
+	// VK_KHR_timeline_semaphore has to be enabled on the Device
+	// the 64 bit counter only increases, a wait for value returns once the counter reached it
+	class TimelineSemaphore : public Semaphore {
+	public:
+		struct CreateInfo : impl::CreateInfo {
+			uint64_t initialValue = 0;
+			VkSemaphoreCreateFlags flags = 0;
+		};
+
+		VULKAN_WRAPPER_API TimelineSemaphore() = default;
+		VULKAN_WRAPPER_API TimelineSemaphore(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API TimelineSemaphore(uint64_t initialValue);
+		VULKAN_WRAPPER_API ~TimelineSemaphore() = default;
+		VULKAN_WRAPPER_API TimelineSemaphore(const TimelineSemaphore & rhs) = default;
+		VULKAN_WRAPPER_API TimelineSemaphore(TimelineSemaphore && rhs) = default;
+		VULKAN_WRAPPER_API TimelineSemaphore & operator = (const TimelineSemaphore & rhs) = default;
+		VULKAN_WRAPPER_API TimelineSemaphore & operator = (TimelineSemaphore && rhs) = default;
+
+		VULKAN_WRAPPER_API void createTimelineSemaphore(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API void createTimelineSemaphore(uint64_t initialValue = 0);
+
+		VULKAN_WRAPPER_API uint64_t value() const;
+		VULKAN_WRAPPER_API void signal(uint64_t value); // host signal
+		VULKAN_WRAPPER_API bool wait(uint64_t value, uint64_t timeOut = std::numeric_limits<uint64_t>::max()) const; // returns false if timeOut ran out first
+
+		// one vkWaitSemaphores for all semaphores, values[i] belongs to semaphores[i]
+		VULKAN_WRAPPER_API static bool waitAll(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+		VULKAN_WRAPPER_API static bool waitAny(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+	private:
+		static bool waitSemaphores(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, VkSemaphoreWaitFlagsKHR flags, uint64_t timeOut);
+	};
+
+
+
 
 	class Fence : public impl::Object<impl::VkwFence> {
 	public:
@@ -80,16 +122,51 @@ namespace vkw {
 		VULKAN_WRAPPER_API Fence(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API Fence(VkFenceCreateFlags flags);
 		VULKAN_WRAPPER_API ~Fence() = default;
+		VULKAN_WRAPPER_API Fence(const Fence & rhs) = default;
+		VULKAN_WRAPPER_API Fence(Fence && rhs) = default;
+		VULKAN_WRAPPER_API Fence & operator = (const Fence & rhs) = default;
+		VULKAN_WRAPPER_API Fence & operator = (Fence && rhs) = default;
 
 		VULKAN_WRAPPER_API void createFence(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createFence(VkFenceCreateFlags flags = 0);
 
 		VkFenceCreateFlags flags;
 
-		VULKAN_WRAPPER_API void wait(bool reset = true, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+		VULKAN_WRAPPER_API bool wait(bool reset = true, uint64_t timeOut = std::numeric_limits<uint64_t>::max()); // false if timeOut ran out first, the fence isn't reset then
 		VULKAN_WRAPPER_API void reset();
+		VULKAN_WRAPPER_API bool isSignaled() const;
 
 		VULKAN_WRAPPER_API static void reset(std::vector<Fence> & fences);
+
+		// one vkWaitForFences for all fences, returns false if timeOut ran out first
+		VULKAN_WRAPPER_API static bool waitAll(const std::vector<VkFence> & fences, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+		VULKAN_WRAPPER_API static bool waitAny(const std::vector<VkFence> & fences, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+		VULKAN_WRAPPER_API static bool waitAll(const std::vector<Fence> & fences, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+		VULKAN_WRAPPER_API static bool waitAny(const std::vector<Fence> & fences, uint64_t timeOut = std::numeric_limits<uint64_t>::max());
+	private:
+		static bool waitForFences(const std::vector<VkFence> & fences, VkBool32 waitAll, uint64_t timeOut);
+	};
+
+
+
+	/// Fence Pool
+	// recycles released Fences instead of destroying them, acquire() only creates a new Fence if none is free
+	// released Fences are reset together with one vkResetFences on the next acquire
+	class FencePool : tools::NonCopyable {
+	public:
+		VULKAN_WRAPPER_API FencePool();
+		VULKAN_WRAPPER_API ~FencePool() = default;
+
+		const size_t & createdCount; // number of Fences created by this pool
+
+		VULKAN_WRAPPER_API Fence acquire(); // returns an unsignaled Fence
+		VULKAN_WRAPPER_API void release(const Fence & fence); // fence must not be in use by a pending submit
+		VULKAN_WRAPPER_API size_t freeCount();
+	private:
+		std::mutex mutex;
+		std::vector<Fence> freeFences;
+		std::vector<Fence> releasedFences; // not reset yet
+		size_t createdCount_m = 0;
 	};
 	
 
@@ -107,6 +184,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API RenderPass() = default;
 		VULKAN_WRAPPER_API RenderPass(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ~RenderPass() = default;
+		VULKAN_WRAPPER_API RenderPass(const RenderPass & rhs) = default;
+		VULKAN_WRAPPER_API RenderPass(RenderPass && rhs) = default;
+		VULKAN_WRAPPER_API RenderPass & operator = (const RenderPass & rhs) = default;
+		VULKAN_WRAPPER_API RenderPass & operator = (RenderPass && rhs) = default;
 
 		VULKAN_WRAPPER_API void createRenderPass(const CreateInfo & createInfo);
 		
@@ -131,6 +212,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API ShaderModule(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ShaderModule(std::string filename, VkShaderStageFlagBits stage, VkShaderModuleCreateFlags flags = 0);
 		VULKAN_WRAPPER_API ~ShaderModule() = default;
+		VULKAN_WRAPPER_API ShaderModule(const ShaderModule & rhs) = default;
+		VULKAN_WRAPPER_API ShaderModule(ShaderModule && rhs) = default;
+		VULKAN_WRAPPER_API ShaderModule & operator = (const ShaderModule & rhs) = default;
+		VULKAN_WRAPPER_API ShaderModule & operator = (ShaderModule && rhs) = default;
 
 		VULKAN_WRAPPER_API void createShaderModule(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createShaderModule(std::string filename, VkShaderStageFlagBits stage, VkShaderModuleCreateFlags flags = 0);
@@ -156,6 +241,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API PipelineLayout(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API PipelineLayout(const std::vector<VkDescriptorSetLayout> & setLayouts, const std::vector<VkPushConstantRange> & pushConstants);
 		VULKAN_WRAPPER_API ~PipelineLayout() = default;
+		VULKAN_WRAPPER_API PipelineLayout(const PipelineLayout & rhs) = default;
+		VULKAN_WRAPPER_API PipelineLayout(PipelineLayout && rhs) = default;
+		VULKAN_WRAPPER_API PipelineLayout & operator = (const PipelineLayout & rhs) = default;
+		VULKAN_WRAPPER_API PipelineLayout & operator = (PipelineLayout && rhs) = default;
 
 		VULKAN_WRAPPER_API void createPipelineLayout(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createPipelineLayout(const std::vector<VkDescriptorSetLayout> & setLayouts, const std::vector<VkPushConstantRange> & pushConstants);
@@ -180,6 +269,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API PipelineCache(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API PipelineCache(size_t initialSize, void* initialData, VkPipelineCacheCreateFlags flags = 0);
 		VULKAN_WRAPPER_API ~PipelineCache() = default;
+		VULKAN_WRAPPER_API PipelineCache(const PipelineCache & rhs) = default;
+		VULKAN_WRAPPER_API PipelineCache(PipelineCache && rhs) = default;
+		VULKAN_WRAPPER_API PipelineCache & operator = (const PipelineCache & rhs) = default;
+		VULKAN_WRAPPER_API PipelineCache & operator = (PipelineCache && rhs) = default;
 
 		VULKAN_WRAPPER_API void createPipelineCache(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createPipelineCache(size_t initialSize = 0, void* initialData = nullptr, VkPipelineCacheCreateFlags flags = 0);
@@ -236,7 +329,34 @@ namespace vkw {
 
 	class ComputePipeline : public impl::Object<impl::VkwPipeline> {
 	public:
-		/*VULKAN_WRAPER_API ComputePipeline() = default;
-		VULKAN_WRAPER_API ~ComputePipeline() = default;*/
+		struct CreateInfo : impl::CreateInfo {
+			VkPipelineShaderStageCreateInfo					shaderStage;
+			VkPipelineLayout								layout;
+			VkPipelineCreateFlags							flags = 0;
+			VkPipelineCache									cache = VK_NULL_HANDLE;
+			VkPipeline										basePipelineHandle = VK_NULL_HANDLE;
+			int32_t											basePipelineIndex = -1;
+		};
+
+		VULKAN_WRAPPER_API ComputePipeline() = default;
+		VULKAN_WRAPPER_API ComputePipeline(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ComputePipeline(ShaderModule & shader, VkPipelineLayout layout, const VkSpecializationInfo * specializationInfo = nullptr, VkPipelineCache cache = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API ~ComputePipeline() = default;
+		VULKAN_WRAPPER_API ComputePipeline(const ComputePipeline & rhs) = default;
+		VULKAN_WRAPPER_API ComputePipeline(ComputePipeline && rhs) = default;
+		VULKAN_WRAPPER_API ComputePipeline & operator = (const ComputePipeline & rhs) = default;
+		VULKAN_WRAPPER_API ComputePipeline & operator = (ComputePipeline && rhs) = default;
+
+		VkPipelineShaderStageCreateInfo					shaderStage;
+		VkPipelineLayout								layout;
+		VkPipelineCreateFlags							flags = 0;
+		VkPipeline										basePipelineHandle = VK_NULL_HANDLE;
+		int32_t											basePipelineIndex = -1;
+		VkPipelineCache									cache = VK_NULL_HANDLE;
+
+		VULKAN_WRAPPER_API void createPipeline(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API void createPipeline(ShaderModule & shader, VkPipelineLayout layout, const VkSpecializationInfo * specializationInfo = nullptr, VkPipelineCache cache = VK_NULL_HANDLE); // shader has to be a compute shader
+
+		VULKAN_WRAPPER_API void bind(VkCommandBuffer commandBuffer) const;
 	};
 }
\ No newline at end of file
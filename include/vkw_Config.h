@@ -40,8 +40,15 @@
 #include <vector>
 #include <assert.h>
 #include <map>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <unordered_map>
 #include <set>
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <initializer_list>
+#include <utility>
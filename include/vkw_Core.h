@@ -49,6 +49,75 @@ namespace vkw {
 	};
 
 
+	/// Host Allocator
+	// VkAllocationCallbacks for the host memory the driver allocates, set through Instance::CreateInfo::allocationCallbacks
+	// small allocations come from arena chunks with one free list per size class, bigger or stricter aligned ones from the system
+	// command scope allocations only live during a single call, they get their own arena so they don't fragment the long lived ones
+	// has to outlive every Vulkan object created with its callbacks
+	class HostAllocator : tools::NonCopyable {
+	public:
+		struct Statistics {
+			size_t allocationCount = 0;
+			size_t reallocationCount = 0;
+			size_t freeCount = 0;
+			size_t usedSize = 0;		// bytes requested by the driver that are still allocated
+			size_t peakSize = 0;
+			size_t internalSize = 0;	// reported through the internal allocation notifications, not allocated by us
+		};
+
+		static const uint32_t scopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1; // VK_SYSTEM_ALLOCATION_SCOPE_RANGE_SIZE is gone from newer headers
+
+		VULKAN_WRAPPER_API HostAllocator(size_t chunkSize = 64 * 1024);
+		VULKAN_WRAPPER_API ~HostAllocator();
+
+		VULKAN_WRAPPER_API operator const VkAllocationCallbacks * () const;
+
+		VULKAN_WRAPPER_API Statistics statistics(VkSystemAllocationScope scope) const;
+		VULKAN_WRAPPER_API Statistics totalStatistics() const;
+		VULKAN_WRAPPER_API size_t reservedSize() const; // bytes taken from the system for arena chunks and big allocations, without alignment padding
+		VULKAN_WRAPPER_API void resetPeaks();
+
+		const size_t & chunkSize;
+	private:
+		static const size_t sizeClassCount = 8; // blocks of 32 to 4096 bytes, header included
+		static const size_t minBlockSize = 32;
+		static const uint32_t bigAllocation = std::numeric_limits<uint32_t>::max();
+
+		struct Header { // in front of every allocation, keeps the user pointer 16 byte aligned
+			uint64_t size;
+			uint32_t sizeClass;
+			uint16_t scope;
+			uint16_t offset; // from the start of a big allocation to the header
+		};
+
+		struct Arena {
+			std::array<void*, sizeClassCount> freeLists = {};
+			std::vector<char*> chunks;
+			char * cursor = nullptr;
+			size_t remaining = 0;
+		};
+
+		size_t chunkSize_m;
+		VkAllocationCallbacks callbacks;
+		Arena arenas[2]; // 0: command scope, 1: every other scope
+		std::array<Statistics, scopeCount> scopeStatistics;
+		size_t bigSize = 0;
+		mutable std::mutex mutex;
+
+		void * allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+		void * reallocate(void * original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		void free(void * memory);
+		void * allocateBlock(Arena & arena, uint32_t sizeClass);
+
+		static void * VKAPI_PTR allocationFunction(void * userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static void * VKAPI_PTR reallocationFunction(void * userData, void * original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static void VKAPI_PTR freeFunction(void * userData, void * memory);
+		static void VKAPI_PTR internalAllocationNotification(void * userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+		static void VKAPI_PTR internalFreeNotification(void * userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+	};
+
+
+
 	class Instance : public impl::CoreObject<impl::VkwInstance>{
 	public:
 		struct CreateInfo : impl::CreateInfo{
@@ -56,6 +125,7 @@ namespace vkw {
 			std::vector<const char*> desiredLayers;
 			std::vector<VkDebugUtilsMessengerCreateInfoEXT> debugMessengerInfos;
 			VkApplicationInfo appInfo;
+			const VkAllocationCallbacks * allocationCallbacks = nullptr; // used for every object of the instance and its devices, see HostAllocator
 		};
 
 		VULKAN_WRAPPER_API Instance();
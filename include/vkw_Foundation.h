@@ -8,6 +8,7 @@
 
 namespace vkw {
 	struct PhysicalDevice;
+	class FencePool;
 
 	enum DestructionControl : uint32_t {
 		VKW_DESTR_CONTRL_DO_NOTHING = 1,
@@ -38,6 +39,7 @@ namespace vkw {
 		struct VkwDescriptorPool		{using Type = VkDescriptorPool		;};
 		struct VkwDescriptorSetLayout	{using Type = VkDescriptorSetLayout	;};
 		struct VkwDescriptorSet			{using Type = VkDescriptorSet		;};
+		struct VkwDescriptorUpdateTemplate	{using Type = VkDescriptorUpdateTemplate;};
 		struct VkwDeviceMemory			{using Type = VkDeviceMemory		;};
 		struct VkwFence					{using Type = VkFence				;};
 		struct VkwFramebuffer			{using Type = VkFramebuffer			;};
@@ -56,52 +58,76 @@ namespace vkw {
 
 
 
+		struct NoParent {};
+
+		// handle a Vulkan object needs to be destroyed, stored next to the object in its VkObject
+		template<typename T> struct ParentOf { using Type = NoParent; };
+		template<> struct ParentOf<VkwCommandBuffer> { using Type = VkCommandPool; };
+
+		// destroys object, selected at compile time by the tag type and the registry type
+		template<typename T, typename RegType> void destroyHandle(RegType & registry, typename T::Type object, const typename ParentOf<T>::Type & parent);
+
+
+
+		// reference counted node shared by every Base that wraps the same Vulkan object
+		// nodes come from a free list per thread and type, creating or copying a Base does not allocate
 		template<typename T> class VkObject : tools::NonCopyable{
 			using Type = typename T::Type;
+			using Parent = typename ParentOf<T>::Type;
 		public:
-			VkObject(std::function<void(Type)> & delf, std::function<void(void)> callback);
-			~VkObject();
+			static VkObject<T> * create(); // reference count of 1
+			void recycle();	// the Vulkan object has to be destroyed already
 
-			void add(VkObject<T> *& ref);
-			void remove(VkObject<T> *& ref, std::function<void(Type)> deleterf);
-			void deleteThis(std::function<void(Type)> deleterf);  //delterf = overwrite to ::deleterFunc 
-			uint32_t referenceCount();
+			void addReference();
+			bool release(); // true if this was the last reference
+			uint32_t referenceCount() const;
 
 			Type * getPtr();
-			Type getObj();
-			operator typename T::Type();
+			Type getObj() const;
+			operator typename T::Type() const;
 
 			void operator = (const Type & rhs);
+
+			Parent parent = {};
+			Type ** tracker = nullptr; // set to nullptr on recycle if it still points to this object
 		private:
-			std::function<void(void)> deleterCallback;
-			std::function<void(Type)> deleterFunc = 0;
-			std::vector<VkObject<T>**> references;
+			VkObject() = default;
+
+			std::atomic<uint32_t> references{ 0 };
 			Type object = VK_NULL_HANDLE;
+			VkObject<T> * nextFree = nullptr;
+
+			static thread_local VkObject<T> * freeList;
+			static const size_t chunkSize = 64;
 		};
 
 
 
 		template<typename T, typename RegType> class VkPointer {
 			using Type = typename T::Type;
+			using Parent = typename ParentOf<T>::Type;
 		public:
-			VkPointer(RegType & reg, DestructionControl & destrContr, std::function<void(Type)> deleterf);
-			VkPointer(const VkPointer<T, RegType> & obj);
+			VkPointer(RegType & reg, DestructionControl & destrContr);
+			VkPointer(const VkPointer<T, RegType> & obj) = delete;
 
 			void copy(const VkPointer<T, RegType> & obj);
+			void move(VkPointer<T, RegType> & obj) noexcept; // takes over the node of obj, obj is left empty
 			void destroyObject();
+			bool destroysObject() const; // true if destroyObject() would destroy the Vulkan object, e.g. this is its last reference
 
 			operator Type * () const;
 			Type operator *() const;
 			void operator = (Type rhs);
 
 			Type * createNew();
-			//VkPointer<T, RegType> & operator = (VkPointer<T, RegType> & rhs);
+			void setParent(const Parent & parent);
 
 		private:
 			RegType & registry;
-			mutable VkObject<T> * pObject = nullptr;
+			VkObject<T> * pObject = nullptr;
 			DestructionControl & destructionControl;
-			std::function<void(Type)> deleterFunc;
+
+			void release();
 		};
 
 
@@ -113,8 +139,9 @@ namespace vkw {
 		template<typename T, typename RegType> class Base {
 			using Type = typename T::Type;
 		public:
-			Base(std::function<void(Type)> deleterf = 0);
+			Base();
 			VULKAN_WRAPPER_API Base(const Base<T, RegType> & rhs);
+			VULKAN_WRAPPER_API Base(Base<T, RegType> && rhs) noexcept;
 			VULKAN_WRAPPER_API ~Base();
 
 			DestructionControl destructionControl = VKW_DESTR_CONTRL_LAST_OBJECT_CALLS_DELETER;
@@ -122,7 +149,7 @@ namespace vkw {
 
 			VULKAN_WRAPPER_API virtual void destroyObject();
 			VULKAN_WRAPPER_API Base<T, RegType> & operator = (const Base<T, RegType> & rhs);
-			//VULKAN_WRAPER_API Base<T, RegType> & operator = (Base<T, RegType> && rhs);
+			VULKAN_WRAPPER_API Base<T, RegType> & operator = (Base<T, RegType> && rhs) noexcept;
 			VULKAN_WRAPPER_API operator typename T::Type () const;
 			VULKAN_WRAPPER_API Type * getPtr() const; 
 		protected:
@@ -179,7 +206,7 @@ namespace vkw {
 
 		class Registry : tools::NonCopyable{
 		public:
-			Registry(const VkInstance & instance);
+			Registry(const VkInstance & instance, const VkAllocationCallbacks * const & allocationCallbacks);
 			~Registry() = default;
 
 			void initialize(VkDevice dev,
@@ -191,7 +218,28 @@ namespace vkw {
 
 			template<typename T> VkObject<T> * getNew();
 
+			// deferred destruction: while enabled the last Base releasing an object doesn't destroy it right away,
+			// it is destroyed once the frame it was released in finished on the GPU, so nothing has to wait for the device to be idle
+			void setDeferredDestruction(bool enable);
+			void endFrame(VkFence fence); // fence is signaled by the last submit of the frame, it must not be destroyed before the frame was collected
+			void endFrame(VkSemaphore timelineSemaphore, uint64_t value); // the frame finished once the semaphore reached value
+			void collectGarbage(); // destroys the objects of every finished frame, doesn't block
+			void flushDeletionQueue(); // waits for the device to be idle and destroys every pending object
+			size_t pendingDestructionCount() const; // releases included
+
+			template<typename T> void destroyDeferred(typename T::Type object, const typename ParentOf<T>::Type & parent);
+
+			// CPU side bookkeeping of a released object, e.g. the range of a Buffer in its Memory, is handed back with the same frame
+			using ReleaseFunction = void(*)(void * context, uint64_t offset, uint64_t size);
+			void releaseDeferred(ReleaseFunction release, void * context, uint64_t offset, uint64_t size);
+			void cancelReleases(const void * context); // drops the pending releases of context, context is about to be destroyed
+
+			// Fences of the transfers that aren't given a FencePool, e.g. Buffer::copyFromBuffer, so a copy doesn't create and destroy a VkFence
+			FencePool & fencePool();
+			void destroyFencePool(); // the pooled Fences have to be destroyed before the device
+
 			const VkInstance	 & instance;
+			const VkAllocationCallbacks * const & allocationCallbacks; // passed to every create and destroy call, null uses the driver's allocator
 			const PhysicalDevice & physicalDevice;
 			const VkDevice		 & device;
 								 
@@ -200,51 +248,78 @@ namespace vkw {
 			const DeviceQueue	 & presentQueue;
 			const DeviceQueue	 & computeQueue;
 
+			// VK_KHR_timeline_semaphore entry points of device, resolved once by initialize(), null if the extension isn't enabled
+			struct TimelineSemaphoreFunctions {
+				PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue = nullptr;
+				PFN_vkSignalSemaphoreKHR signalSemaphore = nullptr;
+				PFN_vkWaitSemaphoresKHR waitSemaphores = nullptr;
+			};
+			const TimelineSemaphoreFunctions & timelineSemaphoreFunctions;
+
+			// VK_KHR_descriptor_update_template entry points of device, resolved once by initialize(), null if the extension isn't enabled
+			struct DescriptorUpdateTemplateFunctions {
+				PFN_vkCreateDescriptorUpdateTemplateKHR createDescriptorUpdateTemplate = nullptr;
+				PFN_vkUpdateDescriptorSetWithTemplateKHR updateDescriptorSetWithTemplate = nullptr;
+				PFN_vkDestroyDescriptorUpdateTemplateKHR destroyDescriptorUpdateTemplate = nullptr;
+			};
+			const DescriptorUpdateTemplateFunctions & descriptorUpdateTemplateFunctions;
+
 			VkReference<VkCommandPool> transferCommandPool;
 			VkReference<VkCommandPool> graphicsCommandPool;
 			VkReference<VkCommandPool> computeCommandPool;
 
 		private:
 			PhysicalDevice		physicalDevice_m;
-			VkDevice 			device_m;
+			VkDevice 			device_m = VK_NULL_HANDLE;
 
 			DeviceQueue			graphicsQueue_m;
 			DeviceQueue			transferQueue_m;
 			DeviceQueue			presentQueue_m;
 			DeviceQueue			computeQueue_m;
 
+			TimelineSemaphoreFunctions timelineSemaphoreFunctions_m;
+			DescriptorUpdateTemplateFunctions descriptorUpdateTemplateFunctions_m;
+			FencePool		  * fencePool_m = nullptr;
+
 			VkCommandPool	  * transferCommandPool_m;
 			VkCommandPool	  * graphicsCommandPool_m;
 			VkCommandPool	  * computeCommandPool_m;
 
+			// handles are stored as their bits so objects of every type share one queue
+			struct PendingDestruction {
+				void(*destroy)(Registry & registry, uint64_t object, uint64_t parent);
+				uint64_t object;
+				uint64_t parent;
+			};
+
+			struct PendingRelease {
+				ReleaseFunction release;
+				void * context;
+				uint64_t offset;
+				uint64_t size;
+			};
+
+			struct RetiredFrame {
+				std::vector<PendingDestruction> destructions;
+				std::vector<PendingRelease> releases; // run after the destructions of the frame
+				VkFence fence = VK_NULL_HANDLE;
+				VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+				uint64_t value = 0;
+			};
+
+			bool deferDestruction_m = false;
+			std::vector<PendingDestruction> currentFrame_m; // released since the last endFrame
+			std::vector<PendingRelease> currentReleases_m;
+			std::deque<RetiredFrame> retiredFrames_m; // oldest first
+			std::vector<std::vector<PendingDestruction>> spareLists_m; // keeps the capacity of collected frames
+			mutable std::mutex deletionMutex_m;
+
+			void retireFrame(RetiredFrame && frame);
+			bool isFinished(const RetiredFrame & frame);
+			void destroyPending(std::vector<PendingDestruction> & destructions, std::vector<PendingRelease> & releases);
+
 			template<typename T> inline VkObject<T> * create();
 			template<typename T> inline VkObject<T> * create(typename T::Type *& object);
-			template<typename T> inline std::function<void(typename T::Type)> getDeleter();
-			template<typename T> std::function<void(T)> setDeleterFunction(std::function<void(T, VkAllocationCallbacks*)> deletef);
-			template<typename T> std::function<void(T)> setDeleterFunction(std::function<void(VkInstance, T, VkAllocationCallbacks*)> deletef);
-			template<typename T> std::function<void(T)> setDeleterFunction(std::function<void(VkDevice, T, VkAllocationCallbacks*)> deletef);
-
-			std::function<void(VkBuffer)>				bufferDeleter;
-			std::function<void(VkBufferView)>			bufferViewDeleter; //
-			std::function<void(VkCommandPool)>			commandPoolDeleter;
-			std::function<void(VkDescriptorPool)>		descriptorPoolDeleter;
-			std::function<void(VkDescriptorSetLayout)>	descriptorSetLayoutDeleter;
-			std::function<void(VkDeviceMemory)>			deviceMemoryDeleter;
-			std::function<void(VkFence)>				fenceDeleter;
-			std::function<void(VkFramebuffer)>			frameBufferDeleter;
-			std::function<void(VkEvent)>				eventDeleter; //
-			std::function<void(VkImage)>				imageDeleter;
-			std::function<void(VkImageView)>			imageViewDeleter;
-			std::function<void(VkPipelineCache)>		pipelineCacheDeleter;
-			std::function<void(VkPipeline)>				pipelineDeleter;
-			std::function<void(VkPipelineLayout)>		pipelineLayoutDeleter;
-			std::function<void(VkRenderPass)>			renderPassDeleter;
-			std::function<void(VkSampler)>				samplerDeleter;
-			std::function<void(VkSemaphore)>			semaphoreDeleter;
-			std::function<void(VkShaderModule)>			shaderModuleDeleter;
-			std::function<void(VkSurfaceKHR)>			surfaceDeleter;
-			std::function<void(VkSwapchainKHR)>			swapchainDeleter;
-			std::function<void(VkQueryPool)>			queryPoolDeleter; //
 		};
 
 
@@ -255,22 +330,29 @@ namespace vkw {
 			template<typename T> VkObject<T> * getNew();
 
 			Registry & getRegistry();
+			Registry * getRegistry(VkDevice device); // nullptr if no Registry belongs to device
 			
 			Registry * createNewRegistry();
 
+			// has to be set before the Instance is created and stay valid until every object is destroyed
+			void setAllocationCallbacks(const VkAllocationCallbacks * callbacks);
+
 			VkReference<VkInstance>		  instance;
 			const std::vector<Surface>	& surfaces;
+			const VkAllocationCallbacks * const & allocationCallbacks;
 
 		private:
-			std::function<void(VkInstance)>		instanceDeleter = 0;
-			std::function<void(VkDevice)>		deviceDeleter = 0;
-			std::function<void(VkSurfaceKHR)>	surfaceDeleter = 0;
-
 			VkInstance			  * instance_m;
+			const VkAllocationCallbacks * allocationCallbacks_m = nullptr;
 			std::vector<Surface>	surfaces_m;
 
 			std::vector<Registry*> registrys;
 		};
+
+		template <typename Reg> Reg & getRegistry();
+
+		template <> VULKAN_WRAPPER_API RegistryManager & getRegistry();
+		template <> VULKAN_WRAPPER_API Registry & getRegistry();
 	}
 }
 
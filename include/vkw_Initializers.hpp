@@ -77,6 +77,15 @@ namespace vkw {
 		}
 
 
+		inline VkSemaphoreTypeCreateInfoKHR semaphoreTypeCreateInfo(VkSemaphoreTypeKHR semaphoreType, uint64_t initialValue = 0) {
+			VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+			typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+			typeInfo.semaphoreType = semaphoreType;
+			typeInfo.initialValue = initialValue;
+			return typeInfo;
+		}
+
+
 		inline VkFenceCreateInfo fenceCreateInfo() {
 			VkFenceCreateInfo createInfo = {};
 			createInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -226,7 +235,7 @@ namespace vkw {
 
 		inline VkComputePipelineCreateInfo computePipelineCreateInfo() {
 			VkComputePipelineCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 			return createInfo;
 		}
 
@@ -266,6 +275,13 @@ namespace vkw {
 		}
 
 
+		inline VkDescriptorUpdateTemplateCreateInfo descriptorUpdateTemplateCreateInfo() {
+			VkDescriptorUpdateTemplateCreateInfo createInfo = {};
+			createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+			return createInfo;
+		}
+
+
 		inline VkMemoryAllocateInfo memoryAllocateInfo() {
 			VkMemoryAllocateInfo allocInfo = {};
 			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
@@ -300,6 +316,13 @@ namespace vkw {
 		}
 
 
+		inline VkBufferMemoryBarrier bufferMemoryBarrier() {
+			VkBufferMemoryBarrier bufferBarrier = {};
+			bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			return bufferBarrier;
+		}
+
+
 		inline VkSamplerCreateInfo samplerCreateInfo() {
 			VkSamplerCreateInfo createInfo = {};
 			createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -334,6 +357,13 @@ namespace vkw {
 		}
 
 
+		inline VkCommandBufferInheritanceInfo commandBufferInheritanceInfo() {
+			VkCommandBufferInheritanceInfo inheritanceInfo = {};
+			inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+			return inheritanceInfo;
+		}
+
+
 		inline VkSubmitInfo submitInfo() {
 			VkSubmitInfo submitInfo = {};
 			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -341,6 +371,13 @@ namespace vkw {
 		}
 
 
+		inline VkTimelineSemaphoreSubmitInfoKHR timelineSemaphoreSubmitInfo() {
+			VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+			timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+			return timelineInfo;
+		}
+
+
 		inline VkRenderPassBeginInfo renderPassBeginInfo() {
 			VkRenderPassBeginInfo renderPassInfo = {};
 			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
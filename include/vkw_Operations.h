@@ -1,7 +1,10 @@
 #pragma once
 #include "vkw_Include.h"
+#include "vkw_Assets.h"
+#include "vkw_Resources.h"
 
 #define VKW_DEFAULT_QUEUE -1
+#define VKW_DEFAULT_STAGING_BELT_SIZE (16ull * 1024 * 1024)
 
 namespace vkw {
 	class CommandBuffer;
@@ -17,10 +20,16 @@ namespace vkw {
 		VULKAN_WRAPPER_API CommandPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API CommandPool(uint32_t queueFamily, VkCommandPoolCreateFlags flags = 0);
 		VULKAN_WRAPPER_API ~CommandPool() = default;
+		VULKAN_WRAPPER_API CommandPool(const CommandPool & rhs) = default;
+		VULKAN_WRAPPER_API CommandPool(CommandPool && rhs) = default;
+		VULKAN_WRAPPER_API CommandPool & operator = (const CommandPool & rhs) = default;
+		VULKAN_WRAPPER_API CommandPool & operator = (CommandPool && rhs) = default;
 
 		VULKAN_WRAPPER_API void createCommandPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createCommandPool(uint32_t queueFamily, VkCommandPoolCreateFlags flags = 0);
 
+		VULKAN_WRAPPER_API void reset(VkCommandPoolResetFlags flags = 0); // resets every CommandBuffer allocated from this pool
+
 		uint32_t queueFamily;
 		VkCommandPoolCreateFlags flags = 0;
 	};
@@ -43,19 +52,31 @@ namespace vkw {
 		VULKAN_WRAPPER_API CommandBuffer();
 		VULKAN_WRAPPER_API CommandBuffer(const AllocInfo & allocInfo);
 		VULKAN_WRAPPER_API CommandBuffer(VkCommandPool commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		VULKAN_WRAPPER_API CommandBuffer(const CommandBuffer & rhs);
+		VULKAN_WRAPPER_API CommandBuffer(CommandBuffer && rhs) noexcept;
 		VULKAN_WRAPPER_API ~CommandBuffer() = default;
 
 		VULKAN_WRAPPER_API void allocateCommandBuffer(const AllocInfo & allocInfo);
 		VULKAN_WRAPPER_API void allocateCommandBuffer(VkCommandPool commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
+		VULKAN_WRAPPER_API CommandBuffer & operator = (const CommandBuffer & rhs);
+		VULKAN_WRAPPER_API CommandBuffer & operator = (CommandBuffer && rhs) noexcept;
+
 		VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		const VkCommandPool & commandPool;
 
 		VULKAN_WRAPPER_API void freeCommandBuffer();
 		VULKAN_WRAPPER_API void beginCommandBuffer(VkCommandBufferUsageFlags flags = 0, VkCommandBufferInheritanceInfo * inheritanceInfo = nullptr);
+		VULKAN_WRAPPER_API void beginSecondary(VkRenderPass renderPass, uint32_t subpass = 0, VkFramebuffer frameBuffer = VK_NULL_HANDLE, VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT); // continues the render pass
+		VULKAN_WRAPPER_API void executeCommands(const std::vector<VkCommandBuffer> & secondaryCommandBuffers);
 		VULKAN_WRAPPER_API void endCommandBuffer();
 		VULKAN_WRAPPER_API void resetCommandBuffer(VkCommandBufferResetFlags flags = 0);
-		VULKAN_WRAPPER_API void submitCommandBuffer(VkQueue queue, std::vector<VkSemaphore> semaphore = {}, VkFence fence = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API void submitCommandBuffer(VkQueue queue, const std::vector<VkSemaphore> & semaphore = {}, VkFence fence = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API void submitCommandBuffer(VkQueue queue, const std::vector<VkSemaphore> & waitSemaphores, const std::vector<VkPipelineStageFlags> & waitStages, const std::vector<VkSemaphore> & signalSemaphores = {}, VkFence fence = VK_NULL_HANDLE);
+
+		VULKAN_WRAPPER_API void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+		VULKAN_WRAPPER_API void dispatchThreads(uint32_t threadCountX, uint32_t threadCountY, uint32_t threadCountZ, uint32_t localSizeX, uint32_t localSizeY = 1, uint32_t localSizeZ = 1); // rounds the group count up, the shader has to skip threads outside of threadCount
+		VULKAN_WRAPPER_API void dispatchIndirect(VkBuffer buffer, VkDeviceSize offset = 0); // buffer holds a VkDispatchIndirectCommand at offset
 	private:
 		VkCommandPool commandPool_m;
 	};
@@ -74,6 +95,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API TransferCommandPool(int queueFamilyIndex);
 		VULKAN_WRAPPER_API TransferCommandPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ~TransferCommandPool() = default;
+		VULKAN_WRAPPER_API TransferCommandPool(const TransferCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API TransferCommandPool(TransferCommandPool && rhs) = default;
+		VULKAN_WRAPPER_API TransferCommandPool & operator = (const TransferCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API TransferCommandPool & operator = (TransferCommandPool && rhs) = default;
 
 		VULKAN_WRAPPER_API void createTransferCommandPool(int queueFamilyIndex = VKW_DEFAULT_QUEUE);
 		VULKAN_WRAPPER_API void createTransferCommandPool(const CreateInfo & createInfo);
@@ -90,6 +115,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API GraphicsCommandPool(int queueFamilyIndex);
 		VULKAN_WRAPPER_API GraphicsCommandPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ~GraphicsCommandPool() = default;
+		VULKAN_WRAPPER_API GraphicsCommandPool(const GraphicsCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API GraphicsCommandPool(GraphicsCommandPool && rhs) = default;
+		VULKAN_WRAPPER_API GraphicsCommandPool & operator = (const GraphicsCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API GraphicsCommandPool & operator = (GraphicsCommandPool && rhs) = default;
 
 		VULKAN_WRAPPER_API void createGraphicsCommandPool(int queueFamilyIndex = VKW_DEFAULT_QUEUE);
 		VULKAN_WRAPPER_API void createGraphicsCommandPool(const CreateInfo & createInfo);
@@ -106,8 +135,369 @@ namespace vkw {
 		VULKAN_WRAPPER_API ComputeCommandPool(int queueFamilyIndex);
 		VULKAN_WRAPPER_API ComputeCommandPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ~ComputeCommandPool() = default;
+		VULKAN_WRAPPER_API ComputeCommandPool(const ComputeCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API ComputeCommandPool(ComputeCommandPool && rhs) = default;
+		VULKAN_WRAPPER_API ComputeCommandPool & operator = (const ComputeCommandPool & rhs) = default;
+		VULKAN_WRAPPER_API ComputeCommandPool & operator = (ComputeCommandPool && rhs) = default;
 
 		VULKAN_WRAPPER_API void createComputeCommandPool(int queueFamilyIndex = VKW_DEFAULT_QUEUE);
 		VULKAN_WRAPPER_API void createComputeCommandPool(const CreateInfo & createInfo);
 	};
+
+
+
+	/// Command Pool Manager
+	// one transient CommandPool per thread and frame so recording from worker threads needs no locking
+	// CommandBuffers are not freed but recycled, nextFrame() resets all pools of the next frame with one call each
+	class CommandPoolManager : tools::NonCopyable {
+	public:
+		struct CreateInfo {
+			uint32_t queueFamily;
+			uint32_t frameCount = 2;
+		};
+
+		VULKAN_WRAPPER_API CommandPoolManager(uint32_t queueFamily, uint32_t frameCount = 2);
+		VULKAN_WRAPPER_API CommandPoolManager(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~CommandPoolManager() = default;
+
+		const uint32_t & queueFamily;
+		const uint32_t & frameCount;
+		const uint32_t & frameIndex;
+
+		VULKAN_WRAPPER_API CommandBuffer & getCommandBuffer(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY); // valid until the frame comes around again
+		VULKAN_WRAPPER_API VkCommandPool getCommandPool(); // pool of the calling thread for the current frame
+
+		// the GPU has to be done with the commands of the frame that gets reset and no thread may be recording
+		VULKAN_WRAPPER_API void nextFrame();
+	private:
+		struct FramePool {
+			CommandPool commandPool;
+			std::deque<CommandBuffer> primary;
+			std::deque<CommandBuffer> secondary;
+			size_t usedPrimary = 0;
+			size_t usedSecondary = 0;
+		};
+
+		uint32_t queueFamily_m;
+		uint32_t frameCount_m;
+		uint32_t frameIndex_m = 0;
+
+		std::mutex mutex;
+		std::unordered_map<std::thread::id, std::vector<FramePool>> threadPools;
+
+		FramePool & framePool();
+	};
+
+
+
+	/// Parallel Encoder
+	// splits a list of draws over persistent worker threads, every worker records its part into a secondary CommandBuffer
+	// the secondaries come from commandPools so each worker uses its own pool
+	class ParallelEncoder : tools::NonCopyable {
+	public:
+		using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>; // records items [first, first + count)
+
+		VULKAN_WRAPPER_API ParallelEncoder(CommandPoolManager & commandPools, uint32_t threadCount = std::thread::hardware_concurrency());
+		VULKAN_WRAPPER_API ~ParallelEncoder();
+
+		const uint32_t & threadCount;
+
+		// returns the secondaries in item order, they are valid until commandPools resets their frame
+		VULKAN_WRAPPER_API std::vector<VkCommandBuffer> encode(uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer, const RecordFunction & record);
+		// records the secondaries into primaryCommandBuffer, the render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		VULKAN_WRAPPER_API void encode(VkCommandBuffer primaryCommandBuffer, uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer, const RecordFunction & record);
+	private:
+		CommandPoolManager & commandPools;
+		uint32_t threadCount_m;
+
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workDone;
+		std::function<void(uint32_t worker)> task;
+		uint64_t generation = 0;
+		uint32_t pending = 0;
+		bool stop = false;
+
+		void workerLoop(uint32_t worker);
+	};
+
+
+
+	/// Submit Builder
+	// collects command buffers with their wait and signal semaphores and submits them with one vkQueueSubmit per queue
+	// queues are submitted in order of their first use, a binary semaphore has to be signaled on a queue used before the waiting one
+	// timeline semaphores (value != 0) have no such restriction and allow transfer -> compute -> graphics chains without fences
+	class SubmitBuilder : tools::NonCopyable {
+	public:
+		VULKAN_WRAPPER_API SubmitBuilder();
+		VULKAN_WRAPPER_API ~SubmitBuilder() = default;
+
+		const uint32_t & submitCount; // number of VkSubmitInfos added since the last execute
+
+		// starts a new VkSubmitInfo on queue, the following calls add to it
+		VULKAN_WRAPPER_API SubmitBuilder & submit(VkQueue queue);
+		VULKAN_WRAPPER_API SubmitBuilder & commandBuffer(VkCommandBuffer commandBuffer);
+		VULKAN_WRAPPER_API SubmitBuilder & wait(VkSemaphore semaphore, VkPipelineStageFlags stageMask, uint64_t value = 0); // value: only for timeline semaphores
+		VULKAN_WRAPPER_API SubmitBuilder & signal(VkSemaphore semaphore, uint64_t value = 0);
+
+		VULKAN_WRAPPER_API bool empty() const;
+		VULKAN_WRAPPER_API void execute(VkFence fence = VK_NULL_HANDLE); // fence is signaled with the submit of the last queue, clears the builder
+		VULKAN_WRAPPER_API void clear();
+	private:
+		struct Submit {
+			std::vector<VkCommandBuffer> commandBuffers;
+			std::vector<VkSemaphore> waitSemaphores;
+			std::vector<VkPipelineStageFlags> waitStages;
+			std::vector<uint64_t> waitValues;
+			std::vector<VkSemaphore> signalSemaphores;
+			std::vector<uint64_t> signalValues;
+			bool timeline = false;
+		};
+
+		std::vector<std::pair<VkQueue, std::vector<Submit>>> queues; // in order of first use
+		Submit * current = nullptr;
+		uint32_t submitCount_m = 0;
+	};
+
+
+
+	/// Queue Submit Batch
+	// gathers the submits of a frame for one queue and hands them to the driver with one vkQueueSubmit on flush()
+	// submits without wait semaphores are appended to the previous VkSubmitInfo if that one signals nothing
+	// all arrays are kept between flushes, adding a submit does not allocate once the batch has warmed up
+	class QueueSubmitBatch : tools::NonCopyable {
+	public:
+		struct Statistics {
+			uint64_t commandBufferCount = 0; // command buffers added
+			uint64_t submitInfoCount = 0;	 // VkSubmitInfos handed to the driver
+			uint64_t queueSubmitCount = 0;	 // vkQueueSubmit calls
+			uint64_t submitsSaved = 0;		 // vkQueueSubmit calls one submitCommandBuffer per command buffer would have needed in addition
+		};
+
+		VULKAN_WRAPPER_API QueueSubmitBatch(VkQueue queue = VK_NULL_HANDLE); // VK_NULL_HANDLE: registry.graphicsQueue
+		VULKAN_WRAPPER_API ~QueueSubmitBatch() = default;
+
+		const VkQueue & queue;
+
+		VULKAN_WRAPPER_API void add(VkCommandBuffer commandBuffer, const std::vector<VkSemaphore> & signalSemaphores = {});
+		VULKAN_WRAPPER_API void add(VkCommandBuffer commandBuffer, const std::vector<VkSemaphore> & waitSemaphores, const std::vector<VkPipelineStageFlags> & waitStages, const std::vector<VkSemaphore> & signalSemaphores = {});
+
+		VULKAN_WRAPPER_API bool empty();
+		VULKAN_WRAPPER_API void flush(VkFence fence = VK_NULL_HANDLE); // a fence is submitted even if the batch is empty
+
+		VULKAN_WRAPPER_API Statistics statistics();
+		VULKAN_WRAPPER_API void resetStatistics();
+	private:
+		struct Range {
+			uint32_t firstCommandBuffer;
+			uint32_t commandBufferCount;
+			uint32_t firstWait;
+			uint32_t waitCount;
+			uint32_t firstSignal;
+			uint32_t signalCount;
+		};
+
+		VkQueue queue_m;
+
+		std::mutex mutex;
+		std::vector<Range> ranges;
+		std::vector<VkCommandBuffer> commandBuffers;
+		std::vector<VkSemaphore> waitSemaphores;
+		std::vector<VkPipelineStageFlags> waitStages;
+		std::vector<VkSemaphore> signalSemaphores;
+		std::vector<VkSubmitInfo> submitInfos;
+		Statistics statistics_m;
+	};
+
+
+
+	/// Transfer Ticket
+	// returned by the asynchronous copies, keeps the CommandBuffer alive until the transfer has finished
+	// with a fencePool the Fence is taken from the pool and given back by wait()
+	// move only, a ticket that is destroyed or assigned to while its transfer is pending waits for it
+	class TransferTicket {
+	public:
+		VULKAN_WRAPPER_API TransferTicket() = default;
+		VULKAN_WRAPPER_API TransferTicket(CommandBuffer & commandBuffer, VkQueue queue, std::vector<VkSemaphore> signalSemaphores = {}, FencePool * fencePool = nullptr); // ends and submits commandBuffer
+		VULKAN_WRAPPER_API TransferTicket(const TransferTicket & rhs) = delete;
+		VULKAN_WRAPPER_API TransferTicket(TransferTicket && rhs) noexcept;
+		VULKAN_WRAPPER_API ~TransferTicket();
+
+		VULKAN_WRAPPER_API TransferTicket & operator = (const TransferTicket & rhs) = delete;
+		VULKAN_WRAPPER_API TransferTicket & operator = (TransferTicket && rhs) noexcept;
+
+		Fence fence;
+		CommandBuffer commandBuffer;
+
+		VULKAN_WRAPPER_API bool isDone() const;
+		VULKAN_WRAPPER_API bool wait(uint64_t timeOut = std::numeric_limits<uint64_t>::max()); // false if timeOut ran out first, nothing is released then
+
+		VULKAN_WRAPPER_API static bool waitAll(std::vector<TransferTicket *> tickets, uint64_t timeOut = std::numeric_limits<uint64_t>::max()); // one vkWaitForFences for all tickets
+	private:
+		FencePool * fencePool = nullptr;
+	};
+
+
+
+	/// Barrier Builder
+	// collects image and buffer barriers and records them with one vkCmdPipelineBarrier
+	// stage masks are the union of the stages of all old and new layouts
+	class BarrierBuilder : tools::NonCopyable {
+	public:
+		VULKAN_WRAPPER_API BarrierBuilder();
+		VULKAN_WRAPPER_API ~BarrierBuilder() = default;
+
+		const VkPipelineStageFlags & srcStageMask;
+		const VkPipelineStageFlags & dstStageMask;
+
+		VULKAN_WRAPPER_API void transition(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+		VULKAN_WRAPPER_API void transition(Image & image, VkImageLayout newLayout, const VkImageSubresourceRange & range);
+		VULKAN_WRAPPER_API void buffer(VkBuffer buffer, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+		VULKAN_WRAPPER_API void buffer(const SubBuffer & buffer, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask);
+
+		// queue family ownership transfer of an exclusive buffer, release is recorded on the srcQueueFamily and acquire on the dstQueueFamily
+		// both halves need the same families and range and the acquiring submit has to wait for the releasing one with a semaphore
+		// nothing is recorded if both families are the same
+		VULKAN_WRAPPER_API void releaseBuffer(VkBuffer buffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+		VULKAN_WRAPPER_API void acquireBuffer(VkBuffer buffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+		// barrier for an image without a tracked layout, e.g. a VkImage that is only known by its handle
+		VULKAN_WRAPPER_API void image(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange & range, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask);
+		VULKAN_WRAPPER_API bool contains(VkImage image) const;
+
+		// turns every collected barrier into the release half of an ownership transfer and adds the matching acquire half to acquire
+		// layout transitions are kept in both halves, the dst stages move to acquire
+		VULKAN_WRAPPER_API void splitOwnershipTransfer(uint32_t srcQueueFamily, uint32_t dstQueueFamily, BarrierBuilder & acquire);
+
+		VULKAN_WRAPPER_API bool empty() const;
+		VULKAN_WRAPPER_API void record(VkCommandBuffer commandBuffer, VkDependencyFlags dependencyFlags = 0); // clears the builder
+		VULKAN_WRAPPER_API void clear();
+	private:
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		VkPipelineStageFlags srcStageMask_m = 0;
+		VkPipelineStageFlags dstStageMask_m = 0;
+	};
+
+
+
+	/// Transfer Batch
+	// collects copies and records them on submit with one vkCmdCopy* per src/dst pair into a single CommandBuffer
+	// buffer regions that are contiguous in src and dst are merged into one region
+	class TransferBatch : tools::NonCopyable {
+	public:
+		struct CreateInfo {
+			VkCommandPool commandPool = VK_NULL_HANDLE; // VK_NULL_HANDLE: registry.transferCommandPool
+			VkQueue queue = VK_NULL_HANDLE; // VK_NULL_HANDLE: registry.transferQueue
+			uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED; // family of queue, VK_QUEUE_FAMILY_IGNORED: registry.transferQueue.family if queue is VK_NULL_HANDLE
+			uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED; // family that consumes the uploads, VK_QUEUE_FAMILY_IGNORED: registry.graphicsQueue.family
+		};
+
+		VULKAN_WRAPPER_API TransferBatch(VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
+		VULKAN_WRAPPER_API TransferBatch(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~TransferBatch() = default;
+
+		const uint32_t & copyCount; // number of regions added since the last submit
+
+		VULKAN_WRAPPER_API void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy & region);
+		VULKAN_WRAPPER_API void copyBuffer(const SubBuffer & srcBuffer, const SubBuffer & dstBuffer, VkDeviceSize size = VK_WHOLE_SIZE);
+		VULKAN_WRAPPER_API void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy> & regions, VkImageLayout dstLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+		// layout transitions recorded in one barrier before respectively after all copies of the batch
+		VULKAN_WRAPPER_API void transitionBeforeCopies(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+		VULKAN_WRAPPER_API void transitionAfterCopies(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+		VULKAN_WRAPPER_API bool empty() const;
+		VULKAN_WRAPPER_API void record(VkCommandBuffer commandBuffer); // records every collected copy into commandBuffer and clears the batch
+		VULKAN_WRAPPER_API TransferTicket submit(std::vector<VkSemaphore> signalSemaphores = {}); // Fence of the ticket comes from the batch's FencePool, wait for the ticket before the batch is destroyed
+		VULKAN_WRAPPER_API void clear();
+
+		// if queueFamily and dstQueueFamily differ every copied buffer range and image is released to dstQueueFamily after the copies
+		// recordAcquire has to be recorded on dstQueueFamily in a submit that waits for a semaphore signaled by submit()
+		VULKAN_WRAPPER_API bool transfersOwnership() const;
+		VULKAN_WRAPPER_API bool needsAcquire() const;
+		VULKAN_WRAPPER_API void recordAcquire(VkCommandBuffer commandBuffer); // acquires everything released since the last call
+		VULKAN_WRAPPER_API TransferTicket submitAcquire(VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE); // registry.graphicsCommandPool/graphicsQueue, the tickets of the releases have to be done
+	private:
+		struct ImageCopies {
+			VkImageLayout layout;
+			std::vector<VkBufferImageCopy> regions;
+		};
+
+		impl::Registry & registry;
+		VkCommandPool commandPool;
+		VkQueue queue;
+		uint32_t queueFamily;
+		uint32_t dstQueueFamily;
+		uint32_t copyCount_m = 0;
+
+		std::map<std::pair<VkBuffer, VkBuffer>, std::vector<VkBufferCopy>> bufferCopies; // first: src, dst
+		std::map<std::pair<VkBuffer, VkImage>, ImageCopies> imageCopies; // first: src, dst
+		BarrierBuilder barriersBefore;
+		BarrierBuilder barriersAfter;
+		BarrierBuilder acquireBarriers;
+		FencePool fencePool;
+
+		void releaseOwnership();
+
+		static void mergeRegions(std::vector<VkBufferCopy> & regions);
+	};
+
+
+
+	/// Staging Belt
+	// ring buffer inside of one persistently mapped Buffer, uploads are collected in one TransferBatch per submit
+	// the space of a submit is reused once its Fence signals, images have to be in dstLayout when the upload executes
+	class StagingBelt : tools::NonCopyable {
+	public:
+		struct CreateInfo {
+			VkDeviceSize size = VKW_DEFAULT_STAGING_BELT_SIZE;
+			VkCommandPool commandPool = VK_NULL_HANDLE; // VK_NULL_HANDLE: registry.transferCommandPool
+			VkQueue queue = VK_NULL_HANDLE; // VK_NULL_HANDLE: registry.transferQueue
+			uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED; // see TransferBatch
+			uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+		};
+
+		VULKAN_WRAPPER_API StagingBelt(VkDeviceSize size = VKW_DEFAULT_STAGING_BELT_SIZE, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, uint32_t queueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
+		VULKAN_WRAPPER_API StagingBelt(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~StagingBelt();
+
+		static const VkDeviceSize bufferUploadAlignment = 4; // offset of buffer uploads inside the belt, vkCmdCopyBuffer needs no more
+
+		const VkDeviceSize & size;
+		const Buffer & buffer;
+
+		VULKAN_WRAPPER_API void upload(VkBuffer dstBuffer, const void * data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+		VULKAN_WRAPPER_API void upload(const SubBuffer & dstBuffer, const void * data, VkDeviceSize size);
+		VULKAN_WRAPPER_API void upload(VkImage dstImage, const void * data, VkDeviceSize size, std::vector<VkBufferImageCopy> regions, VkImageLayout dstLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL); // bufferOffset of the regions is relative to data
+
+		VULKAN_WRAPPER_API void submit(std::vector<VkSemaphore> signalSemaphores = {}); // submits every upload recorded since the last submit
+		VULKAN_WRAPPER_API void wait(); // waits until every submitted upload has finished
+
+		// queue family ownership of the uploads, see TransferBatch
+		VULKAN_WRAPPER_API bool needsAcquire() const;
+		VULKAN_WRAPPER_API void recordAcquire(VkCommandBuffer commandBuffer);
+		VULKAN_WRAPPER_API TransferTicket submitAcquire(VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE);
+	private:
+		struct Submission {
+			TransferTicket ticket;
+			VkDeviceSize end; // head of the ring at submit
+		};
+
+		impl::Registry & registry;
+		VkDeviceSize size_m;
+
+		Memory memory;
+		Buffer buffer_m;
+		TransferBatch batch;
+
+		VkDeviceSize head = 0;
+		VkDeviceSize tail = 0;
+		std::list<Submission> inFlight;
+
+		VkDeviceSize reserve(VkDeviceSize size, VkDeviceSize alignment);
+		bool tryReserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize & offset);
+		void recycle();
+	};
 }
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 #include "vkw_Include.h"
+#include "vkw_Assets.h"
 
 
 
+#define VKW_DEFAULT_MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+
 namespace vkw {
 	class Buffer;
 	class Image;
 	class SubBuffer;
+	class TransferTicket;
+	class BarrierBuilder;
+	class FencePool;
+	class DescriptorUpdateTemplate;
     
 
 
@@ -43,12 +50,15 @@ namespace vkw {
 		VULKAN_WRAPPER_API DescriptorPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API DescriptorPool(const CreateInfo2 & createInfo);
 		VULKAN_WRAPPER_API DescriptorPool(const std::vector<VkDescriptorPoolSize> & poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags = 0);
+		VULKAN_WRAPPER_API DescriptorPool(const DescriptorPool & rhs);
+		VULKAN_WRAPPER_API DescriptorPool(DescriptorPool && rhs) noexcept;
 
 		VULKAN_WRAPPER_API void createDescriptorPool(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createDescriptorPool(const CreateInfo2 & createInfo);
 		VULKAN_WRAPPER_API void createDescriptorPool(const std::vector<VkDescriptorPoolSize> & poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags = 0);
 
 		VULKAN_WRAPPER_API DescriptorPool & operator = (const DescriptorPool & rhs);
+		VULKAN_WRAPPER_API DescriptorPool & operator = (DescriptorPool && rhs) noexcept;
 
 		const std::vector<VkDescriptorPoolSize> & poolSizes;
 		const uint32_t & maxSets;
@@ -76,12 +86,15 @@ namespace vkw {
 		VULKAN_WRAPPER_API DescriptorSetLayout();
 		VULKAN_WRAPPER_API DescriptorSetLayout(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API DescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> & bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
+		VULKAN_WRAPPER_API DescriptorSetLayout(const DescriptorSetLayout & rhs);
+		VULKAN_WRAPPER_API DescriptorSetLayout(DescriptorSetLayout && rhs) noexcept;
 		VULKAN_WRAPPER_API ~DescriptorSetLayout() = default;
 
 		VULKAN_WRAPPER_API void createDescriptorSetLayout(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> & bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
 
 		VULKAN_WRAPPER_API DescriptorSetLayout & operator = (const DescriptorSetLayout & p);
+		VULKAN_WRAPPER_API DescriptorSetLayout & operator = (DescriptorSetLayout && rhs) noexcept;
 
 		const std::map<uint32_t, VkDescriptorSetLayoutBinding> & layoutBindings;
 		VkDescriptorSetLayoutCreateFlags flags = 0;
@@ -129,23 +142,297 @@ namespace vkw {
 		VULKAN_WRAPPER_API DescriptorSet();
 		VULKAN_WRAPPER_API DescriptorSet(const AllocInfo & createInfo);
 		VULKAN_WRAPPER_API DescriptorSet(VkDescriptorPool descriptorPool, const DescriptorSetLayout & layout);
+		VULKAN_WRAPPER_API DescriptorSet(const DescriptorSet & rhs);
+		VULKAN_WRAPPER_API DescriptorSet(DescriptorSet && rhs) noexcept;
 		VULKAN_WRAPPER_API ~DescriptorSet() = default;
 
 		VULKAN_WRAPPER_API void allocateDescriptorSet(const AllocInfo & createInfo);
 		VULKAN_WRAPPER_API void allocateDescriptorSet(VkDescriptorPool descriptorPool, const DescriptorSetLayout & layout);
 
 		VULKAN_WRAPPER_API DescriptorSet & operator = (const DescriptorSet & rhs);
+		VULKAN_WRAPPER_API DescriptorSet & operator = (DescriptorSet && rhs) noexcept;
 
 		VkDescriptorPool descriptorPool;
 		const DescriptorSetLayout *& layout;
 
 		VULKAN_WRAPPER_API void update(const std::vector<WriteInfo> & writeInfos, const std::vector<CopyInfo> & copyInfos); //TODO implement copying
+		// writes the whole set from pData, laid out as described by updateTemplate
+		VULKAN_WRAPPER_API void update(const DescriptorUpdateTemplate & updateTemplate, const void * pData);
 		//VULKAN_WRAPPER_API void write(uint32_t dstBinding, uint32_t dstArrayElement, uint32_t descriptorCount, const VkDescriptorImageInfo * pImageInfo = nullptr, const VkDescriptorBufferInfo * pBufferInfo = nullptr, const VkBufferView * pTexelBufferView = nullptr);
 		
-		VULKAN_WRAPPER_API static void allocateDescriptorSets(std::vector<DescriptorSet> descriptorSets);	//TODO: impelement
-		VULKAN_WRAPPER_API static void updateeDescriptorSets(std::vector<UpdateInfo> updateInfos);	//TODO: impelement
+		// one vkAllocateDescriptorSets for all sets, every set uses layout
+		VULKAN_WRAPPER_API static void allocateDescriptorSets(std::vector<DescriptorSet> & descriptorSets, VkDescriptorPool descriptorPool, const DescriptorSetLayout & layout);
+		// one vkAllocateDescriptorSets for all sets, descriptorSets[i] uses layouts[i]
+		VULKAN_WRAPPER_API static void allocateDescriptorSets(std::vector<std::reference_wrapper<DescriptorSet>> descriptorSets, VkDescriptorPool descriptorPool, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts);
+		// one vkUpdateDescriptorSets for the writes and copies of all sets
+		VULKAN_WRAPPER_API static void updateDescriptorSets(const std::vector<UpdateInfo> & updateInfos);
 	private:
 		const DescriptorSetLayout * layout_m = nullptr;
+
+		static VkResult tryAllocateDescriptorSets(std::vector<std::reference_wrapper<DescriptorSet>> & descriptorSets, VkDescriptorPool descriptorPool, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts);
+		static void recordUpdate(const DescriptorSet & set, const std::vector<WriteInfo> & writeInfos, const std::vector<CopyInfo> & copyInfos, std::vector<VkWriteDescriptorSet> & writes, std::vector<VkCopyDescriptorSet> & copies);
+
+		friend class DescriptorAllocator;
+	};
+
+
+
+
+
+	/// Descriptor Update Template
+	// updates a whole set from one block of packed data with a single vkUpdateDescriptorSetWithTemplate (VK_KHR_descriptor_update_template)
+	// without entries the data layout is generated from layout.layoutBindings: the bindings follow each other in binding order,
+	// each descriptor is a VkDescriptorImageInfo, VkDescriptorBufferInfo or VkBufferView depending on its type
+	class DescriptorUpdateTemplate : public impl::Object<impl::VkwDescriptorUpdateTemplate> {
+	public:
+		struct Entry {
+			uint32_t binding;
+			size_t offset;
+			size_t stride;
+			uint32_t dstArrayElement = 0;
+			uint32_t descriptorCount = 0; // 0: the rest of the binding
+		};
+
+		struct CreateInfo : impl::CreateInfo {
+			tools::PtrContainer<DescriptorSetLayout> layout;
+			std::vector<Entry> entries; // empty: packed layout of all bindings
+			VkDescriptorUpdateTemplateCreateFlags flags = 0;
+		};
+
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate();
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate(const DescriptorSetLayout & layout, const std::vector<Entry> & entries = {});
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate(const DescriptorUpdateTemplate & rhs);
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate(DescriptorUpdateTemplate && rhs) noexcept;
+		VULKAN_WRAPPER_API ~DescriptorUpdateTemplate() = default;
+
+		VULKAN_WRAPPER_API void createDescriptorUpdateTemplate(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API void createDescriptorUpdateTemplate(const DescriptorSetLayout & layout, const std::vector<Entry> & entries = {});
+
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate & operator = (const DescriptorUpdateTemplate & rhs);
+		VULKAN_WRAPPER_API DescriptorUpdateTemplate & operator = (DescriptorUpdateTemplate && rhs) noexcept;
+
+		const DescriptorSetLayout *& layout;
+		const std::vector<Entry> & entries;
+		const size_t & dataSize; // bytes read from pData by update()
+
+		// offset of a descriptor inside the data, binding has to be covered by an entry
+		VULKAN_WRAPPER_API size_t offset(uint32_t binding, uint32_t arrayElement = 0) const;
+		VULKAN_WRAPPER_API void update(VkDescriptorSet descriptorSet, const void * pData) const;
+	private:
+		const DescriptorSetLayout * layout_m = nullptr;
+		std::vector<Entry> entries_m;
+		size_t dataSize_m = 0;
+
+		static size_t descriptorSize(VkDescriptorType type);
+	};
+
+
+
+
+
+	/// Descriptor Update Batch
+	// collects writes to many sets, flush() hands all of them to a single vkUpdateDescriptorSets
+	// infos are copied into one backing store per kind, the stores keep their capacity so a steady state batch doesn't allocate
+	class DescriptorUpdateBatch : tools::NonCopyable {
+	public:
+		VULKAN_WRAPPER_API DescriptorUpdateBatch() = default;
+		VULKAN_WRAPPER_API ~DescriptorUpdateBatch() = default;
+
+		VULKAN_WRAPPER_API void write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo & bufferInfo, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo & imageInfo, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, VkBufferView texelBufferView, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const std::vector<VkDescriptorBufferInfo> & bufferInfos, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const std::vector<VkDescriptorImageInfo> & imageInfos, uint32_t arrayElement = 0);
+		// the descriptor type is taken from the layout of set
+		VULKAN_WRAPPER_API void write(const DescriptorSet & set, uint32_t binding, const VkDescriptorBufferInfo & bufferInfo, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void write(const DescriptorSet & set, uint32_t binding, const VkDescriptorImageInfo & imageInfo, uint32_t arrayElement = 0);
+		VULKAN_WRAPPER_API void copy(VkDescriptorSet srcSet, uint32_t srcBinding, VkDescriptorSet dstSet, uint32_t dstBinding, uint32_t descriptorCount = 1, uint32_t srcArrayElement = 0, uint32_t dstArrayElement = 0);
+
+		VULKAN_WRAPPER_API bool empty() const;
+		VULKAN_WRAPPER_API void flush(); // the batch is empty afterwards
+		VULKAN_WRAPPER_API void clear();
+	private:
+		enum InfoStore : uint32_t { BUFFER_INFOS, IMAGE_INFOS, TEXEL_BUFFER_VIEWS };
+
+		struct InfoRef { // the stores may still grow, pointers are only resolved in flush
+			InfoStore store;
+			uint32_t first;
+		};
+
+		std::vector<VkWriteDescriptorSet> writes;
+		std::vector<InfoRef> infoRefs; // one per write
+		std::vector<VkCopyDescriptorSet> copies;
+		std::vector<VkDescriptorBufferInfo> bufferInfos;
+		std::vector<VkDescriptorImageInfo> imageInfos;
+		std::vector<VkBufferView> texelBufferViews;
+
+		void addWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, uint32_t arrayElement, uint32_t descriptorCount, InfoStore store, uint32_t first);
+	};
+
+
+
+
+
+	/// Descriptor Allocator
+	// allocates sets from a chain of DescriptorPools, a new pool is created once the current one runs out
+	// pools are sized from setsPerPool and a ratio of descriptors per set for every type, nothing has to be known up front
+	// for transient sets use one allocator per frame in flight and reset it once the frame finished
+	// not thread safe, use one allocator per thread
+	class DescriptorAllocator : tools::NonCopyable {
+	public:
+		struct PoolSizeRatio {
+			VkDescriptorType type;
+			float descriptorsPerSet;
+		};
+
+		struct CreateInfo : impl::CreateInfo {
+			uint32_t setsPerPool = 64; // sets of the first pool
+			float growthFactor = 2.0f; // every new pool holds this many times the sets of the one before
+			uint32_t maxSetsPerPool = 4096;
+			std::vector<PoolSizeRatio> ratios = {
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+				{ VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+				{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f }
+			};
+			VkDescriptorPoolCreateFlags flags = 0;
+		};
+
+		struct Statistics {
+			uint32_t poolCount = 0;
+			uint32_t allocatedSets = 0;	// since the last reset
+			uint32_t setCapacity = 0;	// maxSets of all pools
+			uint32_t allocatedDescriptors = 0;
+			uint32_t descriptorCapacity = 0;
+			uint32_t exhaustedPools = 0;	// times a pool ran out and the next one was used
+			float utilization = 0.0f;	// allocatedSets / setCapacity
+		};
+
+		VULKAN_WRAPPER_API DescriptorAllocator();
+		VULKAN_WRAPPER_API DescriptorAllocator(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~DescriptorAllocator() = default;
+
+		VULKAN_WRAPPER_API void allocate(DescriptorSet & descriptorSet, const DescriptorSetLayout & layout);
+		VULKAN_WRAPPER_API void allocate(std::vector<DescriptorSet> & descriptorSets, const DescriptorSetLayout & layout); // one vkAllocateDescriptorSets as long as the pool isn't exhausted
+		VULKAN_WRAPPER_API void reset(); // resets every pool, all sets allocated so far become invalid, the pools are kept
+
+		VULKAN_WRAPPER_API Statistics statistics() const;
+		VULKAN_WRAPPER_API void resetStatistics();
+
+		const CreateInfo & info;
+	private:
+		CreateInfo info_m;
+		std::vector<DescriptorPool> pools;
+		size_t currentPool = 0;
+		uint32_t currentPoolSets = 0;
+
+		uint32_t allocatedSets = 0;
+		uint32_t allocatedDescriptors = 0;
+		uint32_t exhaustedPools = 0;
+
+		void allocate(std::vector<std::reference_wrapper<DescriptorSet>> & descriptorSets, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts);
+		DescriptorPool & nextPool();
+	};
+
+
+
+
+
+	/// Descriptor Set Cache
+	// returns the same set for the same layout and written resources, a set is only allocated and written the first time
+	// the key is built from the contents the WriteInfos point to, so the infos may live on the stack
+	// sets not requested for maxUnusedFrames frames are evicted and reused for the next miss with the same layout
+	// not thread safe, use one cache per thread
+	class DescriptorSetCache : tools::NonCopyable {
+	public:
+		struct CreateInfo : impl::CreateInfo {
+			uint32_t framesInFlight = 2; // frames the GPU may still be working on when nextFrame() is called
+			uint32_t maxUnusedFrames = 8; // has to be bigger than framesInFlight, the GPU may still use an evicted set before that
+			DescriptorAllocator::CreateInfo allocatorInfo;
+		};
+
+		struct Statistics {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			uint64_t reusedSets = 0; // misses served by an evicted set instead of a new allocation
+			size_t cachedSets = 0;
+		};
+
+		VULKAN_WRAPPER_API DescriptorSetCache();
+		VULKAN_WRAPPER_API DescriptorSetCache(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~DescriptorSetCache() = default;
+
+		VULKAN_WRAPPER_API VkDescriptorSet get(const DescriptorSetLayout & layout, const std::vector<DescriptorSet::WriteInfo> & writeInfos);
+		VULKAN_WRAPPER_API void nextFrame(); // call once per frame, evicts the sets that weren't requested for maxUnusedFrames
+		VULKAN_WRAPPER_API void clear(); // the device has to be done with every set
+
+		VULKAN_WRAPPER_API Statistics statistics() const;
+		VULKAN_WRAPPER_API void resetStatistics();
+
+		const uint32_t & maxUnusedFrames;
+	private:
+		struct CachedSet {
+			DescriptorSet set;
+			VkDescriptorSetLayout layout;
+			uint64_t lastUsedFrame;
+		};
+
+		uint32_t maxUnusedFrames_m;
+		DescriptorAllocator allocator;
+		std::unordered_map<std::vector<uint64_t>, CachedSet, tools::KeyHash> sets;
+		std::unordered_map<VkDescriptorSetLayout, std::vector<DescriptorSet>> evictedSets;
+		uint64_t frame = 0;
+		Statistics statistics_m;
+
+		// reused between calls so hits don't allocate
+		std::vector<uint64_t> key;
+		std::vector<VkWriteDescriptorSet> writes;
+
+		void buildKey(const DescriptorSetLayout & layout, const std::vector<DescriptorSet::WriteInfo> & writeInfos);
+	};
+
+
+
+
+
+
+	/// Layout Cache
+	// interns DescriptorSetLayouts and PipelineLayouts of one device, equal descriptions get the same handle so pipelines built from them stay compatible
+	// copies of the returned layouts share the handle, it is destroyed once the cache and every copy are gone
+	class LayoutCache : tools::NonCopyable {
+	public:
+		struct Statistics {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			size_t descriptorSetLayouts = 0;
+			size_t pipelineLayouts = 0;
+		};
+
+		VULKAN_WRAPPER_API LayoutCache() = default;
+		VULKAN_WRAPPER_API ~LayoutCache() = default;
+
+		// the references stay valid until clear()
+		VULKAN_WRAPPER_API const DescriptorSetLayout & getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> & bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
+		VULKAN_WRAPPER_API const PipelineLayout & getPipelineLayout(const std::vector<VkDescriptorSetLayout> & setLayouts, const std::vector<VkPushConstantRange> & pushConstants = {});
+		VULKAN_WRAPPER_API void clear();
+
+		VULKAN_WRAPPER_API Statistics statistics() const;
+		VULKAN_WRAPPER_API void resetStatistics();
+	private:
+		mutable std::mutex mutex;
+		std::unordered_map<std::vector<uint64_t>, DescriptorSetLayout, tools::KeyHash> descriptorSetLayouts;
+		std::unordered_map<std::vector<uint64_t>, PipelineLayout, tools::KeyHash> pipelineLayouts;
+		Statistics statistics_m;
+
+		// reused between calls so hits don't allocate
+		std::vector<uint64_t> key;
+		std::vector<VkDescriptorSetLayoutBinding> sortedBindings;
 	};
 
 
@@ -155,17 +442,35 @@ namespace vkw {
 
 	/// Memory
 	struct MemoryRanges {
-		VULKAN_WRAPPER_API bool query(VkDeviceSize size) const;
+		VULKAN_WRAPPER_API bool query(VkDeviceSize size, VkDeviceSize alignment = 1) const;
 		VULKAN_WRAPPER_API void addMoreSize(VkDeviceSize size);
 		VULKAN_WRAPPER_API VkDeviceSize add(VkDeviceSize size);	// returns a offset, if failed max<VkDeviceSize>
-		VULKAN_WRAPPER_API void add(VkDeviceSize offset, VkDeviceSize size);
+		VULKAN_WRAPPER_API VkDeviceSize addAligned(VkDeviceSize size, VkDeviceSize alignment); // returned offset is a multiple of alignment, if failed max<VkDeviceSize>
+		VULKAN_WRAPPER_API void add(VkDeviceSize offset, VkDeviceSize size); // one more reference to a range handed out by add(size) or addAligned()
 		VULKAN_WRAPPER_API void remove(VkDeviceSize offset, VkDeviceSize size);
 		VULKAN_WRAPPER_API void reset();
+
+		VULKAN_WRAPPER_API VkDeviceSize totalSize() const;
+		VULKAN_WRAPPER_API VkDeviceSize usedSize() const;
+		VULKAN_WRAPPER_API uint32_t rangeCount() const;
 	private:
-		std::map<VkDeviceSize, std::multiset<VkDeviceSize>> memoryRanges; // first: offset, second: sizes
-		std::map<VkDeviceSize, VkDeviceSize> freeRanges; // first: offset, second: sizes
+		struct UsedRange {
+			VkDeviceSize size;
+			uint32_t references; // ranges can be shared e.g. by copied SubBuffers
+		};
+
+		std::map<VkDeviceSize, UsedRange> memoryRanges; // first: offset
+		std::map<VkDeviceSize, VkDeviceSize> freeRanges; // first: offset, second: size
+		std::set<std::pair<VkDeviceSize, VkDeviceSize>> freeSizes; // first: size, second: offset; used for best fit lookups
+		VkDeviceSize size_m = 0;
+		VkDeviceSize freeSize_m = 0;
+
+		void insertFreeRange(VkDeviceSize offset, VkDeviceSize size);
+		void eraseFreeRange(std::map<VkDeviceSize, VkDeviceSize>::iterator it);
+		std::set<std::pair<VkDeviceSize, VkDeviceSize>>::const_iterator findFreeRange(VkDeviceSize size, VkDeviceSize alignment) const;
 	};
 
+	// bound Buffers and Images keep a pointer to their Memory, it must not be moved while they use it
 	class Memory : public impl::Object<impl::VkwDeviceMemory> {
 		struct Mapped {
 			VkDeviceSize size = 0;
@@ -184,19 +489,23 @@ namespace vkw {
 			std::vector<std::reference_wrapper<Image>> images;
 			VkDeviceSize additionalSize = 0;
 			uint32_t memoryType = std::numeric_limits<uint32_t>::max();
+			bool persistentlyMapped = false; // maps the whole allocation once, memory has to be host visible
 		};
 
 		VULKAN_WRAPPER_API Memory();
 		VULKAN_WRAPPER_API Memory(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API Memory(AllocInfo & allocInfo);
 		VULKAN_WRAPPER_API Memory(VkMemoryPropertyFlags memoryFlags, VkDeviceSize size = 0);
-		VULKAN_WRAPPER_API ~Memory() = default;
+		VULKAN_WRAPPER_API Memory(const Memory & rhs);
+		VULKAN_WRAPPER_API Memory(Memory && rhs) noexcept;
+		VULKAN_WRAPPER_API ~Memory();
 
 		VULKAN_WRAPPER_API void allocateMemory(AllocInfo & allocInfo);
 		VULKAN_WRAPPER_API void allocateMemory(std::vector<std::reference_wrapper<Buffer>> buffers = {}, std::vector<std::reference_wrapper<Image>> images = {},  VkDeviceSize additionalSize = 0);
 		VULKAN_WRAPPER_API void allocateMemory(VkMemoryPropertyFlags memoryFlags, std::vector<std::reference_wrapper<Buffer>> buffers = {}, std::vector<std::reference_wrapper<Image>> images = {}, VkDeviceSize additionalSize = 0, uint32_t memoryType = std::numeric_limits<uint32_t>::max());
 
 		VULKAN_WRAPPER_API Memory & operator = (const Memory & rhs);
+		VULKAN_WRAPPER_API Memory & operator = (Memory && rhs) noexcept;
 
 		const VkMemoryPropertyFlags & memoryFlags;
 		const Mapped & memoryMap;
@@ -204,6 +513,7 @@ namespace vkw {
 		const uint32_t & memoryTypeBits;
 		const uint32_t & memoryType;
 		const MemoryRanges & memoryRanges;
+		const bool & persistentlyMapped;
 
 		VULKAN_WRAPPER_API void setMemoryTypeBitsBuffer(Buffer & buffer);
 		VULKAN_WRAPPER_API void bindBufferToMemory(Buffer & buffer);
@@ -215,8 +525,15 @@ namespace vkw {
 		VULKAN_WRAPPER_API void setMemoryTypeBits(VkMemoryRequirements & memoryRequirements);
 		VULKAN_WRAPPER_API void * map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkMemoryMapFlags flags = 0);
 		VULKAN_WRAPPER_API void unMap();
+		VULKAN_WRAPPER_API void * mapPersistent(); // while persistently mapped map() and unMap() don't call the driver
+		VULKAN_WRAPPER_API void unMapPersistent();
 		VULKAN_WRAPPER_API void flush();
 		VULKAN_WRAPPER_API void invalidate();
+
+		// non coherent memory: writes are collected as nonCoherentAtomSize aligned ranges and flushed with one call
+		VULKAN_WRAPPER_API void markDirty(VkDeviceSize offset, VkDeviceSize size);
+		VULKAN_WRAPPER_API void flushDirtyRanges();
+		VULKAN_WRAPPER_API bool isCoherent() const; // property of the memory type that was allocated
 	private:
 		VkDeviceSize size_m = 0;
 		Mapped memoryMap_m;
@@ -224,8 +541,53 @@ namespace vkw {
 		uint32_t memoryTypeBits_m = std::numeric_limits<uint32_t>::max();
 		uint32_t memoryType_m = std::numeric_limits<uint32_t>::max();
 		MemoryRanges memoryRanges_m;
+		bool persistentlyMapped_m = false;
+		std::map<VkDeviceSize, VkDeviceSize> dirtyRanges_m; // first: offset, second: end
+
+		VkMappedMemoryRange alignedRange(VkDeviceSize offset, VkDeviceSize size) const;
+		void releaseRange(VkDeviceSize offset, VkDeviceSize size); // deferred like the handle of the Buffer or Image that used it
 
 		friend Buffer;
+		friend Image;
+	};
+
+
+
+	/// Memory Allocator
+	// reserves big Memory blocks per memory type and sub allocates Buffers and Images inside of them
+	// linear (Buffers, linear Images) and optimal resources get seperate blocks so bufferImageGranularity never has to be considered
+	class MemoryAllocator : tools::NonCopyable {
+	public:
+		struct CreateInfo {
+			VkDeviceSize blockSize = VKW_DEFAULT_MEMORY_BLOCK_SIZE;
+		};
+
+		struct Statistics {
+			uint32_t blockCount = 0;		// number of vkAllocateMemory calls currently alive
+			uint32_t allocationCount = 0;	// number of resources bound to the blocks
+			VkDeviceSize reservedSize = 0;	// size of all blocks
+			VkDeviceSize usedSize = 0;		// size taken up by bound resources
+		};
+
+		VULKAN_WRAPPER_API MemoryAllocator(VkDeviceSize blockSize = VKW_DEFAULT_MEMORY_BLOCK_SIZE);
+		VULKAN_WRAPPER_API MemoryAllocator(const CreateInfo & createInfo);
+		VULKAN_WRAPPER_API ~MemoryAllocator() = default;
+
+		const VkDeviceSize & blockSize;
+
+		VULKAN_WRAPPER_API Memory & bindBuffer(Buffer & buffer, VkMemoryPropertyFlags memoryFlags);
+		VULKAN_WRAPPER_API Memory & bindImage(Image & image, VkMemoryPropertyFlags memoryFlags);
+		VULKAN_WRAPPER_API void freeEmptyBlocks();
+
+		VULKAN_WRAPPER_API Statistics statistics() const;
+		VULKAN_WRAPPER_API Statistics statistics(uint32_t memoryType) const;
+	private:
+		impl::Registry & registry;
+		VkDeviceSize blockSize_m;
+		std::map<uint32_t, std::list<Memory>> blocks; // first: memoryType << 1 | optimalTiling, std::list so Memory& in Buffers/Images stay valid
+
+		Memory & findBlock(uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryFlags, bool optimalTiling, VkDeviceSize size, VkDeviceSize alignment);
+		static void addStatistics(Statistics & statistics, const std::list<Memory> & memoryBlocks);
 	};
 	
 
@@ -233,6 +595,7 @@ namespace vkw {
 
 
 	/// Buffer
+	// SubBuffers keep a pointer to their Buffer, it must not be moved while they use it
 	class Buffer : public impl::Object<impl::VkwBuffer> {
 	public:
 		struct CreateInfo : impl::CreateInfo {
@@ -246,12 +609,15 @@ namespace vkw {
 		VULKAN_WRAPPER_API Buffer();
 		VULKAN_WRAPPER_API Buffer(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API Buffer(VkBufferUsageFlags usageFlags, VkDeviceSize size, VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE, VkDeviceSize offset = 0, VkBufferCreateFlags createflags = 0);
+		VULKAN_WRAPPER_API Buffer(const Buffer & rhs);
+		VULKAN_WRAPPER_API Buffer(Buffer && rhs) noexcept;
 		VULKAN_WRAPPER_API ~Buffer();
 
 		VULKAN_WRAPPER_API void createBuffer(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createBuffer(VkBufferUsageFlags usageFlags, VkDeviceSize size, VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE, VkDeviceSize offset = 0, VkBufferCreateFlags createflags = 0);
 
 		VULKAN_WRAPPER_API Buffer & operator = (const Buffer & rhs);
+		VULKAN_WRAPPER_API Buffer & operator = (Buffer && rhs) noexcept;
 
 		VULKAN_WRAPPER_API void destroyObject() override;
 
@@ -267,10 +633,13 @@ namespace vkw {
 		VULKAN_WRAPPER_API SubBuffer createSubBuffer(VkDeviceSize size, VkDeviceSize offset = std::numeric_limits<VkDeviceSize>::max());
 
 		VULKAN_WRAPPER_API void write(const void * data, size_t sizeOfData, VkDeviceSize offset = 0, bool leaveMapped = true);
-		VULKAN_WRAPPER_API inline void map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkMemoryMapFlags flags = 0);
+		VULKAN_WRAPPER_API void * map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkMemoryMapFlags flags = 0);
 		VULKAN_WRAPPER_API inline void flush();
 		VULKAN_WRAPPER_API inline void invalidate();
+		// the copies run on registry.transferQueue if queue is VK_NULL_HANDLE, an exclusive buffer is then released to the graphics queue family
+		// copyFromBuffer also acquires it there, copyFromBufferAsync adds the acquire half to acquire, it has to be recorded on the graphics queue family after the copy finished
 		VULKAN_WRAPPER_API void copyFromBuffer(VkBuffer srcBuffer, VkBufferCopy copyRegion = {}, VkCommandPool commandPool = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API TransferTicket copyFromBufferAsync(VkBuffer srcBuffer, VkBufferCopy copyRegion = {}, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, std::vector<VkSemaphore> signalSemaphores = {}, FencePool * fencePool = nullptr, BarrierBuilder * acquire = nullptr);
 		//VULKAN_WRAPER_API void copyFrom(VkImage image, VkBufferCopy copyRegion, VkCommandPool commandPool = VK_NULL_HANDLE);
 
 		VULKAN_WRAPPER_API VkDescriptorBufferInfo bufferInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
@@ -284,6 +653,9 @@ namespace vkw {
 		MemoryRanges memoryRanges;
 		Memory * memory = nullptr;
 
+		void releaseMemoryRange(); // the range goes back to memory with the last reference to the VkBuffer
+		bool transfersOwnership(VkQueue queue) const; // true if a copy submitted to queue has to release the buffer to the graphics queue family
+
 		friend void Memory::bindBufferToMemory(Buffer & buffer);
 		friend SubBuffer;
 	};
@@ -304,7 +676,8 @@ namespace vkw {
 
 		VULKAN_WRAPPER_API void write(const void * data, size_t sizeOfData, bool leaveMapped = true);
 		VULKAN_WRAPPER_API void copyFrom(const SubBuffer & srcBuffer, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkCommandPool commandPool = VK_NULL_HANDLE);
-		VULKAN_WRAPPER_API void map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkMemoryMapFlags flags = 0);
+		VULKAN_WRAPPER_API TransferTicket copyFromAsync(const SubBuffer & srcBuffer, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, std::vector<VkSemaphore> signalSemaphores = {}, FencePool * fencePool = nullptr, BarrierBuilder * acquire = nullptr);
+		VULKAN_WRAPPER_API void * map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0, VkMemoryMapFlags flags = 0);
 		VULKAN_WRAPPER_API void flush();
 		VULKAN_WRAPPER_API void invalidate();
 		VULKAN_WRAPPER_API void clear();
@@ -317,8 +690,9 @@ namespace vkw {
 		VkDeviceSize size_m;
 		VkDeviceSize offset_m;
 
-		SubBuffer(VkDeviceSize size, VkDeviceSize offset, Buffer * buffer);
+		SubBuffer(VkDeviceSize size, VkDeviceSize offset, Buffer * buffer, bool tracked);
 		Buffer * buffer;
+		bool tracked_m = false; // range was handed out by buffer->memoryRanges, false for an explicit offset
 	};
 
 
@@ -347,16 +721,23 @@ namespace vkw {
 		VULKAN_WRAPPER_API Image();
 		VULKAN_WRAPPER_API Image(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API Image(VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkImageType imageType = VK_IMAGE_TYPE_2D, VkImageCreateFlags flags = 0);
-		VULKAN_WRAPPER_API ~Image() = default;
+		VULKAN_WRAPPER_API Image(const Image & rhs);
+		VULKAN_WRAPPER_API Image(Image && rhs) noexcept;
+		VULKAN_WRAPPER_API ~Image();
 
 		VULKAN_WRAPPER_API void createImage(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createImage(VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkImageType imageType = VK_IMAGE_TYPE_2D, VkImageCreateFlags flags = 0);
 
 		VULKAN_WRAPPER_API Image & operator = (const Image & rhs);
+		VULKAN_WRAPPER_API Image & operator = (Image && rhs) noexcept;
+
+		VULKAN_WRAPPER_API void destroyObject() override;
 
 		const VkImageLayout & layout;
 		const VkExtent3D & extent;
 		const VkDeviceSize & sizeInMemory;
+		const VkDeviceSize & offset; // offset in Memory
+		const VkDeviceSize & allignement;
 		const uint32_t & memoryTypeBits;
 
 		VkImageCreateFlags flags = 0;
@@ -372,20 +753,36 @@ namespace vkw {
 
 		VULKAN_WRAPPER_API void transitionImageLayout(VkImageLayout newLayout, VkImageAspectFlags aspectMask, VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkCommandPool commandPool = VK_NULL_HANDLE);
 		VULKAN_WRAPPER_API void transitionImageLayout(VkImageLayout newLayout, const VkImageSubresourceRange & range, VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkCommandPool commandPool = VK_NULL_HANDLE);
+		// record the transition into commandBuffer, layout is updated right away and is valid once the commandBuffer executed
+		// stage masks of 0 are derived from the old and new layouts
+		VULKAN_WRAPPER_API void recordLayoutTransition(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkImageAspectFlags aspectMask, VkPipelineStageFlags srcStageMask = 0, VkPipelineStageFlags dstStageMask = 0);
+		VULKAN_WRAPPER_API void recordLayoutTransition(VkCommandBuffer commandBuffer, VkImageLayout newLayout, const VkImageSubresourceRange & range, VkPipelineStageFlags srcStageMask = 0, VkPipelineStageFlags dstStageMask = 0);
+		VULKAN_WRAPPER_API std::vector<VkImageMemoryBarrier> layoutBarriers(VkImageLayout newLayout, const VkImageSubresourceRange & range); // one barrier per run of subresources with the same old layout, updates the tracked layouts
+		VULKAN_WRAPPER_API VkImageSubresourceRange subresourceRange(VkImageAspectFlags aspectMask) const; // every mip level and array layer
+		VULKAN_WRAPPER_API VkImageLayout subresourceLayout(uint32_t mipLevel, uint32_t arrayLayer) const;
 
 		VULKAN_WRAPPER_API void copyFromImage(const Image & srcImage, const std::vector<VkImageCopy> & regions = {}, VkCommandPool cmdPool = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API TransferTicket copyFromImageAsync(const Image & srcImage, const std::vector<VkImageCopy> & regions, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, std::vector<VkSemaphore> signalSemaphores = {}, FencePool * fencePool = nullptr);
+		// ownership of an exclusive image is handed to the graphics queue family like in Buffer::copyFromBuffer
 		VULKAN_WRAPPER_API void copyFromBuffer(const VkBuffer & srcBuffer, const std::vector<VkBufferImageCopy> & copyRegions, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE);
+		VULKAN_WRAPPER_API TransferTicket copyFromBufferAsync(const VkBuffer & srcBuffer, const std::vector<VkBufferImageCopy> & copyRegions, VkCommandPool commandPool = VK_NULL_HANDLE, VkQueue queue = VK_NULL_HANDLE, std::vector<VkSemaphore> signalSemaphores = {}, FencePool * fencePool = nullptr, BarrierBuilder * acquire = nullptr);
 		// TODO: make function to copy from an image
 		// TODO: transitionImageLayout should be redone
 	private:
-		VkImageLayout layout_m = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout layout_m = VK_IMAGE_LAYOUT_UNDEFINED; // layout of mip level 0 and array layer 0
+		std::vector<VkImageLayout> layouts_m; // per subresource: arrayLayer * mipLevels + mipLevel
 		VkExtent3D extent_m;
 		VkDeviceSize size_m;
+		VkDeviceSize offset_m = 0;
+		VkDeviceSize allignement_m = 1;
 		uint32_t memoryTypeBits_m;
 
 		friend void Memory::setMemoryTypeBitsImage(Image & image);
 		friend void Memory::bindImageToMemory(Image & image);
 		Memory * memory = nullptr; 
+
+		void releaseMemoryRange(); // the range goes back to memory with the last reference to the VkImage
+		bool transfersOwnership(VkQueue queue) const; // true if a copy submitted to queue has to release the image to the graphics queue family
 	};
 
 
@@ -407,6 +804,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API ImageView(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ImageView(const Image & image, VkImageSubresourceRange subresource, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, VkComponentMapping components = {});
 		VULKAN_WRAPPER_API ~ImageView() = default;
+		VULKAN_WRAPPER_API ImageView(const ImageView & rhs) = default;
+		VULKAN_WRAPPER_API ImageView(ImageView && rhs) = default;
+		VULKAN_WRAPPER_API ImageView & operator = (const ImageView & rhs) = default;
+		VULKAN_WRAPPER_API ImageView & operator = (ImageView && rhs) = default;
 
 		VULKAN_WRAPPER_API void createImageView(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createImageView(const Image & image, VkImageSubresourceRange subresource, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, VkComponentMapping components = {});
@@ -446,6 +847,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API Sampler() = default;
 		VULKAN_WRAPPER_API Sampler(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API ~Sampler() = default;
+		VULKAN_WRAPPER_API Sampler(const Sampler & rhs) = default;
+		VULKAN_WRAPPER_API Sampler(Sampler && rhs) = default;
+		VULKAN_WRAPPER_API Sampler & operator = (const Sampler & rhs) = default;
+		VULKAN_WRAPPER_API Sampler & operator = (Sampler && rhs) = default;
 
 		VULKAN_WRAPPER_API void createSampler(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createSampler();
@@ -478,6 +883,10 @@ namespace vkw {
 		VULKAN_WRAPPER_API FrameBuffer(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API FrameBuffer(VkRenderPass renderPass, VkExtent2D extent, std::vector<VkImageView> attachments, uint32_t layers = 1, VkFramebufferCreateFlags flags = 0);
 		VULKAN_WRAPPER_API ~FrameBuffer() = default;
+		VULKAN_WRAPPER_API FrameBuffer(const FrameBuffer & rhs) = default;
+		VULKAN_WRAPPER_API FrameBuffer(FrameBuffer && rhs) = default;
+		VULKAN_WRAPPER_API FrameBuffer & operator = (const FrameBuffer & rhs) = default;
+		VULKAN_WRAPPER_API FrameBuffer & operator = (FrameBuffer && rhs) = default;
 
 		VULKAN_WRAPPER_API void createFrameBuffer(const CreateInfo & createInfo);
 		VULKAN_WRAPPER_API void createFrameBuffer(VkRenderPass renderPass, VkExtent2D extent, std::vector<VkImageView> attachments, uint32_t layers = 1, VkFramebufferCreateFlags flags = 0);
@@ -1,6 +1,7 @@
 #pragma once
 #include "vkw_Config.h"
 #include <stdlib.h>
+#include <cstring>
 #include <algorithm>
 #include <chrono>
 #include <vector>
@@ -37,6 +38,76 @@ namespace vkw {
 		}
 
 
+		// rounds value up to the next multiple of alignment
+		inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return alignment > 1 ? ((value + alignment - 1) / alignment) * alignment : value;
+		}
+
+		// rounds value down to the previous multiple of alignment
+		inline VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment) {
+			return alignment > 1 ? (value / alignment) * alignment : value;
+		}
+
+		// Vulkan handles are pointers or 64 bit integers depending on the platform, this stores either as 64 bits
+		template<typename H> inline uint64_t handleToBits(const H & handle) {
+			static_assert(sizeof(H) <= sizeof(uint64_t), "handle doesn't fit into 64 bits");
+			uint64_t bits = 0;
+			std::memcpy(&bits, &handle, sizeof(H));
+			return bits;
+		}
+
+		template<typename H> inline H bitsToHandle(uint64_t bits) {
+			H handle;
+			std::memcpy(&handle, &bits, sizeof(H));
+			return handle;
+		}
+
+		inline void hashCombine(size_t & seed, uint64_t value) {
+			seed ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+		}
+
+		// hash for flat std::vector<uint64_t> keys of unordered containers
+		struct KeyHash {
+			size_t operator()(const std::vector<uint64_t> & key) const {
+				size_t seed = key.size();
+				for (auto x : key) hashCombine(seed, x);
+				return seed;
+			}
+		};
+
+		// accesses an image in layout can be used for
+		inline VkAccessFlags accessMaskOf(VkImageLayout layout) {
+			switch (layout) {
+			case VK_IMAGE_LAYOUT_UNDEFINED:							return 0;
+			case VK_IMAGE_LAYOUT_PREINITIALIZED:					return VK_ACCESS_HOST_WRITE_BIT;
+			case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:			return VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:	return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:	return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:			return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:				return VK_ACCESS_TRANSFER_READ_BIT;
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:				return VK_ACCESS_TRANSFER_WRITE_BIT;
+			case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:					return 0;
+			default:												return VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			}
+		}
+
+		// pipeline stages that access an image in layout
+		inline VkPipelineStageFlags stageMaskOf(VkImageLayout layout) {
+			switch (layout) {
+			case VK_IMAGE_LAYOUT_UNDEFINED:							return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			case VK_IMAGE_LAYOUT_PREINITIALIZED:					return VK_PIPELINE_STAGE_HOST_BIT;
+			case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:			return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:	return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:	return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:			return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:				return VK_PIPELINE_STAGE_TRANSFER_BIT;
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:				return VK_PIPELINE_STAGE_TRANSFER_BIT;
+			case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:					return VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			default:												return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			}
+		}
+
+
 		inline int findMemoryType(const VkPhysicalDeviceMemoryProperties & memoryProperties, uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags optimalProperties = 0) {
 			if (optimalProperties != 0) {
 				int index = findMemoryType(memoryProperties, memoryTypeBits, optimalProperties);
@@ -22,7 +22,6 @@
 // TODO: implement a proper Debugger
 // IDEA: add pnext to every ::CreateInfo
 // TODO: standardize which (and how much) data gets stored in the vkw::Objects
-// IDEA: implement a to-be-deleted stack so objects can be declared in a time independent manner
 
 // NOTE: rather use at() for stl containers
 
@@ -20,10 +20,20 @@ namespace vkw {
 
 	}
 
+	Swapchain::Swapchain(const Swapchain & rhs) : Swapchain()
+	{
+		*this = rhs;
+	}
+
+	Swapchain::Swapchain(Swapchain && rhs) noexcept : Swapchain()
+	{
+		*this = std::move(rhs);
+	}
+
 	Swapchain::~Swapchain()
 	{
 		for (auto x : swapChainImageViews) {
-			vkDestroyImageView(registry.device, x, nullptr);
+			vkDestroyImageView(registry.device, x, registry.allocationCallbacks);
 		}
 	};
 
@@ -65,7 +75,7 @@ namespace vkw {
 			createInfo.pQueueFamilyIndices = nullptr; // Optional
 		}
 
-		vkw::Debug::errorCodeCheck(vkCreateSwapchainKHR(registry.device, &createInfo, nullptr, pVkObject.createNew()), "Failed to create Swapchain");
+		vkw::Debug::errorCodeCheck(vkCreateSwapchainKHR(registry.device, &createInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Swapchain");
 
 		vkGetSwapchainImagesKHR(registry.device, *pVkObject, &imageCount_m, nullptr); // get the swapchainImages
 		swapChainImages.resize(imageCount);
@@ -81,7 +91,7 @@ namespace vkw {
 			imageInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 			imageInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 			imageInfo.flags = 0;
-			vkCreateImageView(registry.device, &imageInfo, nullptr, &swapChainImageViews[i]);
+			vkCreateImageView(registry.device, &imageInfo, registry.allocationCallbacks, &swapChainImageViews[i]);
 		}
 	}
 
@@ -91,6 +101,7 @@ namespace vkw {
 
 	Swapchain & Swapchain::operator=(const Swapchain & rhs)
 	{
+		impl::Object<impl::VkwSwapchainKHR>::operator=(rhs);
 		swapChainImages = rhs.swapChainImages;
 		swapChainImageViews = rhs.swapChainImageViews;
 
@@ -102,6 +113,24 @@ namespace vkw {
 		return *this;
 	}
 
+	Swapchain & Swapchain::operator=(Swapchain && rhs) noexcept
+	{
+		impl::Object<impl::VkwSwapchainKHR>::operator=(std::move(rhs));
+
+		// the image views are destroyed by ~Swapchain, only one of the two may still hold them
+		swapChainImages = std::move(rhs.swapChainImages);
+		swapChainImageViews = std::move(rhs.swapChainImageViews);
+		rhs.swapChainImages.clear();
+		rhs.swapChainImageViews.clear();
+
+		surfaceFormat_m = rhs.surfaceFormat_m;
+		presentMode_m = rhs.presentMode_m;
+		extent_m = rhs.extent_m;
+		imageCount_m = std::exchange(rhs.imageCount_m, 0);
+
+		return *this;
+	}
+
 	uint32_t Swapchain::getNextImage(VkSemaphore semaphore, VkFence fence)
 	{
 		uint32_t imageIndex = 0;
@@ -175,7 +204,7 @@ namespace vkw {
 		VkSemaphoreCreateInfo info = init::semaphoreCreateInfo();
 		info.flags = createInfo.flags;
 		info.pNext = createInfo.pNext;
-		Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Semaphore");
+		Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Semaphore");
 	}
 
 	void Semaphore::createSemaphore(VkSemaphoreCreateFlags flags) {
@@ -183,7 +212,102 @@ namespace vkw {
 
 		VkSemaphoreCreateInfo createInfo = init::semaphoreCreateInfo();
 		createInfo.flags = flags;
-		Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &createInfo, nullptr, pVkObject.createNew()), "Failed to create Semaphore");
+		Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &createInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Semaphore");
+	}
+
+
+
+
+	/// Timeline Semaphore
+	TimelineSemaphore::TimelineSemaphore(const CreateInfo & createInfo)
+	{
+		createTimelineSemaphore(createInfo);
+	}
+
+	TimelineSemaphore::TimelineSemaphore(uint64_t initialValue)
+	{
+		createTimelineSemaphore(initialValue);
+	}
+
+	void TimelineSemaphore::createTimelineSemaphore(const CreateInfo & createInfo)
+	{
+		this->flags = createInfo.flags;
+
+		VkSemaphoreTypeCreateInfoKHR typeInfo = init::semaphoreTypeCreateInfo(VK_SEMAPHORE_TYPE_TIMELINE_KHR, createInfo.initialValue);
+		typeInfo.pNext = createInfo.pNext;
+
+		VkSemaphoreCreateInfo info = init::semaphoreCreateInfo();
+		info.flags = createInfo.flags;
+		info.pNext = &typeInfo;
+		Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create TimelineSemaphore");
+	}
+
+	void TimelineSemaphore::createTimelineSemaphore(uint64_t initialValue)
+	{
+		CreateInfo createInfo = {};
+		createInfo.initialValue = initialValue;
+		createTimelineSemaphore(createInfo);
+	}
+
+	uint64_t TimelineSemaphore::value() const
+	{
+		auto func = registry.timelineSemaphoreFunctions.getSemaphoreCounterValue;
+		VKW_assert(func != nullptr, "VK_KHR_timeline_semaphore is not enabled");
+
+		uint64_t value = 0;
+		Debug::errorCodeCheck(func(registry.device, *pVkObject, &value), "Failed to get TimelineSemaphore value");
+		return value;
+	}
+
+	void TimelineSemaphore::signal(uint64_t value)
+	{
+		auto func = registry.timelineSemaphoreFunctions.signalSemaphore;
+		VKW_assert(func != nullptr, "VK_KHR_timeline_semaphore is not enabled");
+
+		VkSemaphoreSignalInfoKHR signalInfo = {};
+		signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+		signalInfo.semaphore = *pVkObject;
+		signalInfo.value = value;
+		Debug::errorCodeCheck(func(registry.device, &signalInfo), "Failed to signal TimelineSemaphore");
+	}
+
+	bool TimelineSemaphore::wait(uint64_t value, uint64_t timeOut) const
+	{
+		return waitSemaphores({ *pVkObject }, { value }, 0, timeOut);
+	}
+
+	bool TimelineSemaphore::waitAll(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, uint64_t timeOut)
+	{
+		return waitSemaphores(semaphores, values, 0, timeOut);
+	}
+
+	bool TimelineSemaphore::waitAny(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, uint64_t timeOut)
+	{
+		return waitSemaphores(semaphores, values, VK_SEMAPHORE_WAIT_ANY_BIT_KHR, timeOut);
+	}
+
+	bool TimelineSemaphore::waitSemaphores(const std::vector<VkSemaphore> & semaphores, const std::vector<uint64_t> & values, VkSemaphoreWaitFlagsKHR flags, uint64_t timeOut)
+	{
+		VKW_assert(semaphores.size() == values.size(), "Every semaphore needs a value to wait for");
+		if (semaphores.empty()) return true;
+
+		impl::Registry & registry = impl::getRegistry<impl::Registry>();
+		VkDevice device = registry.device;
+		auto func = registry.timelineSemaphoreFunctions.waitSemaphores;
+		VKW_assert(func != nullptr, "VK_KHR_timeline_semaphore is not enabled");
+
+		VkSemaphoreWaitInfoKHR waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.flags = flags;
+		waitInfo.semaphoreCount = static_cast<uint32_t>(semaphores.size());
+		waitInfo.pSemaphores = semaphores.data();
+		waitInfo.pValues = values.data();
+
+		VkResult result = func(device, &waitInfo, timeOut);
+		if (result == VK_TIMEOUT) return false;
+
+		Debug::errorCodeCheck(result, "Failed to wait for TimelineSemaphores");
+		return true;
 	}
 
 
@@ -207,7 +331,7 @@ namespace vkw {
 		VkFenceCreateInfo info = init::fenceCreateInfo();
 		info.flags = flags;
 		info.pNext = createInfo.pNext;
-		Debug::errorCodeCheck(vkCreateFence(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Fence");
+		Debug::errorCodeCheck(vkCreateFence(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Fence");
 	}
 
 	void Fence::createFence(VkFenceCreateFlags flags)
@@ -216,13 +340,17 @@ namespace vkw {
 
 		VkFenceCreateInfo createInfo = init::fenceCreateInfo();
 		createInfo.flags = flags;
-		Debug::errorCodeCheck(vkCreateFence(registry.device, &createInfo, nullptr, pVkObject.createNew()), "Failed to create Fence");
+		Debug::errorCodeCheck(vkCreateFence(registry.device, &createInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Fence");
 	}
 
-	void Fence::wait(bool reset, uint64_t timeOut)
+	bool Fence::wait(bool reset, uint64_t timeOut)
 	{
-		Debug::errorCodeCheck(vkWaitForFences(registry.device, 1, pVkObject, VK_TRUE, timeOut), "Failed to wait for Fence");
+		VkResult result = vkWaitForFences(registry.device, 1, pVkObject, VK_TRUE, timeOut);
+		if (result == VK_TIMEOUT) return false;
+
+		Debug::errorCodeCheck(result, "Failed to wait for Fence");
 		if (reset) this->reset();
+		return true;
 	}
 
 	void Fence::reset()
@@ -230,11 +358,19 @@ namespace vkw {
 		vkResetFences(registry.device, 1, pVkObject);
 	}
 
+	bool Fence::isSignaled() const
+	{
+		return vkGetFenceStatus(registry.device, *pVkObject) == VK_SUCCESS;
+	}
+
 	void Fence::reset(std::vector<Fence> & fences)
 	{
-		std::vector<VkFence> vkFences (fences.size());
+		if (fences.empty()) return;
 
-		for (auto x : fences) vkFences.push_back(x);
+		std::vector<VkFence> vkFences;
+		vkFences.reserve(fences.size());
+
+		for (auto & x : fences) vkFences.push_back(x);
 
 		// TODO
 		// debug: check if all fences have same registry
@@ -242,6 +378,78 @@ namespace vkw {
 		vkResetFences(fences[0].registry.device, static_cast<uint32_t>(vkFences.size()), vkFences.data());
 	}
 
+	bool Fence::waitAll(const std::vector<VkFence> & fences, uint64_t timeOut)
+	{
+		return waitForFences(fences, VK_TRUE, timeOut);
+	}
+
+	bool Fence::waitAny(const std::vector<VkFence> & fences, uint64_t timeOut)
+	{
+		return waitForFences(fences, VK_FALSE, timeOut);
+	}
+
+	bool Fence::waitAll(const std::vector<Fence> & fences, uint64_t timeOut)
+	{
+		return waitAll(std::vector<VkFence>(fences.begin(), fences.end()), timeOut);
+	}
+
+	bool Fence::waitAny(const std::vector<Fence> & fences, uint64_t timeOut)
+	{
+		return waitAny(std::vector<VkFence>(fences.begin(), fences.end()), timeOut);
+	}
+
+	bool Fence::waitForFences(const std::vector<VkFence> & fences, VkBool32 waitAll, uint64_t timeOut)
+	{
+		if (fences.empty()) return true;
+
+		VkResult result = vkWaitForFences(impl::getRegistry<impl::Registry>().device, static_cast<uint32_t>(fences.size()), fences.data(), waitAll, timeOut);
+		if (result == VK_TIMEOUT) return false;
+
+		Debug::errorCodeCheck(result, "Failed to wait for Fences");
+		return true;
+	}
+
+
+
+
+	/// Fence Pool
+	FencePool::FencePool() :
+		createdCount(createdCount_m)
+	{}
+
+	Fence FencePool::acquire()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (freeFences.empty() && !releasedFences.empty()) {
+			Fence::reset(releasedFences);
+			freeFences.swap(releasedFences);
+		}
+
+		if (freeFences.empty()) {
+			createdCount_m++;
+			return Fence(0);
+		}
+
+		Fence fence = freeFences.back();
+		freeFences.pop_back();
+		return fence;
+	}
+
+	void FencePool::release(const Fence & fence)
+	{
+		if (static_cast<VkFence>(fence) == VK_NULL_HANDLE) return;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		releasedFences.push_back(fence);
+	}
+
+	size_t FencePool::freeCount()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return freeFences.size() + releasedFences.size();
+	}
+
 
 
 
@@ -269,7 +477,7 @@ namespace vkw {
 		renderPassInfo.subpassCount = static_cast<uint32_t>(subPassDescriptions.size());
 		renderPassInfo.pSubpasses = subPassDescriptions.data();
 
-		Debug::errorCodeCheck(vkCreateRenderPass(registry.device, &renderPassInfo, nullptr, pVkObject.createNew()), "Failed to create Render Pass");
+		Debug::errorCodeCheck(vkCreateRenderPass(registry.device, &renderPassInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Render Pass");
 	}
 
 
@@ -310,7 +518,7 @@ namespace vkw {
 		info.pCode = reinterpret_cast<const uint32_t*> (shaderCode.data());
 		info.pNext = createInfo.pNext;
 
-		Debug::errorCodeCheck(vkCreateShaderModule(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create ShaderModule!");
+		Debug::errorCodeCheck(vkCreateShaderModule(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create ShaderModule!");
 	}
 
 	void ShaderModule::createShaderModule(std::string filename, VkShaderStageFlagBits stage, VkShaderModuleCreateFlags flags)
@@ -360,7 +568,7 @@ namespace vkw {
 		info.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
 		info.pPushConstantRanges = pushConstantRanges.data();
 
-		Debug::errorCodeCheck(vkCreatePipelineLayout(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create pipeline layout!");
+		Debug::errorCodeCheck(vkCreatePipelineLayout(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create pipeline layout!");
 	}
 
 	void PipelineLayout::createPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstants)
@@ -407,7 +615,7 @@ namespace vkw {
 		info.flags = createInfo.flags;
 		info.initialDataSize = createInfo.initialSize;
 		info.pInitialData = createInfo.initialData;
-		Debug::errorCodeCheck(vkCreatePipelineCache(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Pipeline Cache");
+		Debug::errorCodeCheck(vkCreatePipelineCache(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Pipeline Cache");
 	}
 
 
@@ -452,6 +660,56 @@ namespace vkw {
 		pipelineInfo.basePipelineHandle = basePipelineHandle;
 		pipelineInfo.basePipelineIndex = basePipelineIndex;
 
-		Debug::errorCodeCheck(vkCreateGraphicsPipelines(registry.device, cache, 1, &pipelineInfo, nullptr, pVkObject.createNew()), "Failed to create Pipeline");
+		Debug::errorCodeCheck(vkCreateGraphicsPipelines(registry.device, cache, 1, &pipelineInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Pipeline");
 	};
+
+
+
+
+	/// Compute Pipeline
+	ComputePipeline::ComputePipeline(const CreateInfo & createInfo)
+	{
+		createPipeline(createInfo);
+	}
+
+	ComputePipeline::ComputePipeline(ShaderModule & shader, VkPipelineLayout layout, const VkSpecializationInfo * specializationInfo, VkPipelineCache cache)
+	{
+		createPipeline(shader, layout, specializationInfo, cache);
+	}
+
+	void ComputePipeline::createPipeline(const CreateInfo & createInfo)
+	{
+		VKW_assert(createInfo.shaderStage.stage == VK_SHADER_STAGE_COMPUTE_BIT, "ComputePipeline needs a compute shader stage");
+
+		shaderStage = createInfo.shaderStage;
+		layout = createInfo.layout;
+		flags = createInfo.flags;
+		cache = createInfo.cache;
+		basePipelineHandle = createInfo.basePipelineHandle;
+		basePipelineIndex = createInfo.basePipelineIndex;
+
+		VkComputePipelineCreateInfo pipelineInfo = vkw::init::computePipelineCreateInfo();
+		pipelineInfo.flags = flags;
+		pipelineInfo.pNext = createInfo.pNext;
+		pipelineInfo.stage = shaderStage;
+		pipelineInfo.layout = layout;
+		pipelineInfo.basePipelineHandle = basePipelineHandle;
+		pipelineInfo.basePipelineIndex = basePipelineIndex;
+
+		Debug::errorCodeCheck(vkCreateComputePipelines(registry.device, cache, 1, &pipelineInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create ComputePipeline");
+	}
+
+	void ComputePipeline::createPipeline(ShaderModule & shader, VkPipelineLayout layout, const VkSpecializationInfo * specializationInfo, VkPipelineCache cache)
+	{
+		CreateInfo createInfo = {};
+		createInfo.shaderStage = shader.shaderStageInfo(specializationInfo);
+		createInfo.layout = layout;
+		createInfo.cache = cache;
+		createPipeline(createInfo);
+	}
+
+	void ComputePipeline::bind(VkCommandBuffer commandBuffer) const
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *pVkObject);
+	}
 }
@@ -110,6 +110,232 @@ namespace vkw {
 
 
 
+	/// Host Allocator
+	HostAllocator::HostAllocator(size_t chunkSize) :
+		chunkSize(chunkSize_m),
+		chunkSize_m(chunkSize)
+	{
+		VKW_assert(chunkSize >= (minBlockSize << (sizeClassCount - 1)), "chunkSize has to fit the biggest block");
+
+		callbacks.pUserData = this;
+		callbacks.pfnAllocation = &HostAllocator::allocationFunction;
+		callbacks.pfnReallocation = &HostAllocator::reallocationFunction;
+		callbacks.pfnFree = &HostAllocator::freeFunction;
+		callbacks.pfnInternalAllocation = &HostAllocator::internalAllocationNotification;
+		callbacks.pfnInternalFree = &HostAllocator::internalFreeNotification;
+	}
+
+	HostAllocator::~HostAllocator()
+	{
+		for (auto & arena : arenas) {
+			for (auto x : arena.chunks) std::free(x);
+		}
+	}
+
+	HostAllocator::operator const VkAllocationCallbacks*() const
+	{
+		return &callbacks;
+	}
+
+	HostAllocator::Statistics HostAllocator::statistics(VkSystemAllocationScope scope) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return scopeStatistics.at(scope);
+	}
+
+	HostAllocator::Statistics HostAllocator::totalStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Statistics total;
+		for (auto & x : scopeStatistics) {
+			total.allocationCount += x.allocationCount;
+			total.reallocationCount += x.reallocationCount;
+			total.freeCount += x.freeCount;
+			total.usedSize += x.usedSize;
+			total.peakSize += x.peakSize; // the scopes may peak at different times, this is an upper bound
+			total.internalSize += x.internalSize;
+		}
+		return total;
+	}
+
+	size_t HostAllocator::reservedSize() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return (arenas[0].chunks.size() + arenas[1].chunks.size()) * chunkSize_m + bigSize;
+	}
+
+	void HostAllocator::resetPeaks()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto & x : scopeStatistics) x.peakSize = x.usedSize;
+	}
+
+	void * HostAllocator::allocateBlock(Arena & arena, uint32_t sizeClass)
+	{
+		void *& freeList = arena.freeLists[sizeClass];
+		if (freeList) {
+			void * block = freeList;
+			freeList = *reinterpret_cast<void**>(block);
+			return block;
+		}
+
+		size_t blockSize = minBlockSize << sizeClass;
+		if (arena.remaining < blockSize) {
+			// the rest of the old chunk is lost, at most one block of the biggest class
+			char * chunk = static_cast<char*>(std::malloc(chunkSize_m));
+			if (!chunk) return nullptr;
+
+			arena.chunks.push_back(chunk);
+			arena.cursor = chunk;
+			arena.remaining = chunkSize_m;
+		}
+
+		void * block = arena.cursor;
+		arena.cursor += blockSize;
+		arena.remaining -= blockSize;
+		return block;
+	}
+
+	void * HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		if (size == 0) return nullptr;
+
+		Header * header = nullptr;
+
+		if (alignment <= sizeof(Header) && size + sizeof(Header) <= (minBlockSize << (sizeClassCount - 1))) {
+			uint32_t sizeClass = 0;
+			while ((minBlockSize << sizeClass) < size + sizeof(Header)) sizeClass++;
+
+			header = static_cast<Header*>(allocateBlock(arenas[scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ? 0 : 1], sizeClass));
+			if (!header) return nullptr;
+
+			header->sizeClass = sizeClass;
+			header->offset = 0;
+		}
+		else {
+			size_t align = std::max(alignment, sizeof(Header));
+			VKW_assert(align <= std::numeric_limits<uint16_t>::max(), "alignment is too big for the HostAllocator");
+
+			char * raw = static_cast<char*>(std::malloc(size + sizeof(Header) + align));
+			if (!raw) return nullptr;
+
+			// the user pointer is the first aligned address with room for the header in front of it
+			uintptr_t user = (reinterpret_cast<uintptr_t>(raw) + sizeof(Header) + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+			header = reinterpret_cast<Header*>(user) - 1;
+			header->sizeClass = bigAllocation;
+			header->offset = static_cast<uint16_t>(reinterpret_cast<char*>(header) - raw);
+
+			bigSize += size + sizeof(Header);
+		}
+
+		header->size = size;
+		header->scope = static_cast<uint16_t>(scope);
+
+		Statistics & statistics = scopeStatistics.at(scope);
+		statistics.allocationCount++;
+		statistics.usedSize += size;
+		statistics.peakSize = std::max(statistics.peakSize, statistics.usedSize);
+
+		return header + 1;
+	}
+
+	void HostAllocator::free(void * memory)
+	{
+		if (!memory) return;
+
+		Header * header = static_cast<Header*>(memory) - 1;
+
+		Statistics & statistics = scopeStatistics.at(header->scope);
+		statistics.freeCount++;
+		statistics.usedSize -= header->size;
+
+		if (header->sizeClass == bigAllocation) {
+			char * raw = reinterpret_cast<char*>(header) - header->offset;
+			bigSize -= header->size + sizeof(Header);
+			std::free(raw);
+			return;
+		}
+
+		Arena & arena = arenas[header->scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND ? 0 : 1];
+		void *& freeList = arena.freeLists[header->sizeClass];
+		*reinterpret_cast<void**>(header) = freeList;
+		freeList = header;
+	}
+
+	void * HostAllocator::reallocate(void * original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		if (!original) return allocate(size, alignment, scope);
+		if (size == 0) {
+			free(original);
+			return nullptr;
+		}
+
+		Header * header = static_cast<Header*>(original) - 1;
+		Statistics & statistics = scopeStatistics.at(header->scope);
+
+		// stays in its block as long as it fits
+		if (header->sizeClass != bigAllocation && size + sizeof(Header) <= (minBlockSize << header->sizeClass)) {
+			statistics.reallocationCount++;
+			statistics.usedSize = statistics.usedSize - header->size + size;
+			statistics.peakSize = std::max(statistics.peakSize, statistics.usedSize);
+			header->size = size;
+			return original;
+		}
+
+		void * memory = allocate(size, alignment, scope);
+		if (!memory) return nullptr; // the original stays valid
+
+		std::memcpy(memory, original, std::min(static_cast<size_t>(header->size), size));
+		free(original);
+
+		// the pair of allocate and free above is one reallocation
+		Statistics & newStatistics = scopeStatistics.at(scope);
+		newStatistics.allocationCount--;
+		statistics.freeCount--;
+		newStatistics.reallocationCount++;
+
+		return memory;
+	}
+
+	void * VKAPI_PTR HostAllocator::allocationFunction(void * userData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		HostAllocator * allocator = static_cast<HostAllocator*>(userData);
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		return allocator->allocate(size, alignment, scope);
+	}
+
+	void * VKAPI_PTR HostAllocator::reallocationFunction(void * userData, void * original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+	{
+		HostAllocator * allocator = static_cast<HostAllocator*>(userData);
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		return allocator->reallocate(original, size, alignment, scope);
+	}
+
+	void VKAPI_PTR HostAllocator::freeFunction(void * userData, void * memory)
+	{
+		HostAllocator * allocator = static_cast<HostAllocator*>(userData);
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		allocator->free(memory);
+	}
+
+	void VKAPI_PTR HostAllocator::internalAllocationNotification(void * userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+	{
+		HostAllocator * allocator = static_cast<HostAllocator*>(userData);
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		allocator->scopeStatistics.at(scope).internalSize += size;
+	}
+
+	void VKAPI_PTR HostAllocator::internalFreeNotification(void * userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+	{
+		HostAllocator * allocator = static_cast<HostAllocator*>(userData);
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+		allocator->scopeStatistics.at(scope).internalSize -= size;
+	}
+
+
+
+
 	/// Instance
 	Instance::Instance() : 
 		physicalDevices(physicalDevices_m)
@@ -122,7 +348,8 @@ namespace vkw {
 
 	Instance::~Instance()
 	{
-		for (auto x : debugMessengers) destroyDebugUtilsMessengerEXT(x, nullptr);
+		auto messengers = debugMessengers; // destroyDebugUtilsMessengerEXT erases from debugMessengers
+		for (auto x : messengers) destroyDebugUtilsMessengerEXT(x, registry.allocationCallbacks);
 	}
 
 	void Instance::createInstance(const CreateInfo & createInfo)
@@ -135,11 +362,12 @@ namespace vkw {
 		instanceCreateInfo.ppEnabledExtensionNames = createInfo.desiredExtensions.data();
 		instanceCreateInfo.pNext = createInfo.pNext;
 
-		Debug::errorCodeCheck(vkCreateInstance(&instanceCreateInfo, nullptr, pVkObject.createNew()), "Failed to create Instance");
+		registry.setAllocationCallbacks(createInfo.allocationCallbacks);
+		Debug::errorCodeCheck(vkCreateInstance(&instanceCreateInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Instance");
 
 		debugMessengers.resize(createInfo.debugMessengerInfos.size());
 		for (size_t i = 0; i < debugMessengers.size(); i++) {
-			Debug::errorCodeCheck(createDebugUtilsMessengerEXT(createInfo.debugMessengerInfos.at(i), nullptr, debugMessengers.at(i), false), std::string("Failed to create Debug Messenger, index: ",  i).c_str());
+			Debug::errorCodeCheck(createDebugUtilsMessengerEXT(createInfo.debugMessengerInfos.at(i), registry.allocationCallbacks, debugMessengers.at(i), false), std::string("Failed to create Debug Messenger, index: ",  i).c_str());
 		}
 
 		vkw::DebugInformationPrint::printSystemInformation(this->registry.instance);
@@ -359,7 +587,7 @@ namespace vkw {
 		deviceInfo.ppEnabledLayerNames = nullptr;
 		deviceInfo.pNext = createInfo.pNext;
 
-		Debug::errorCodeCheck(vkCreateDevice(createInfo.physicalDevice.physicalDevice, &deviceInfo, nullptr, pVkObject.createNew()), "Failed to create Device");
+		Debug::errorCodeCheck(vkCreateDevice(createInfo.physicalDevice.physicalDevice, &deviceInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Device");
 
 		if (graphicsQueue_m.family >= 0) vkGetDeviceQueue(*pVkObject, graphicsQueue_m.family, graphicsQueue_m.index, &graphicsQueue_m.queue);
 		if (transferQueue_m.family >= 0) vkGetDeviceQueue(*pVkObject, transferQueue_m.family, transferQueue_m.index, &transferQueue_m.queue);
@@ -1,13 +1,12 @@
 #include "vkw_Foundation.h"
 #include "vkw_Core.h"
+#include "vkw_Assets.h"
 
 namespace vkw {
 
 	namespace impl {
 		static RegistryManager registryManager;
 
-		template <typename Reg> Reg & getRegistry();
-
 		template <> RegistryManager & getRegistry() { return registryManager; }
 		template <> Registry & getRegistry() { return registryManager.getRegistry(); }
 
@@ -16,40 +15,44 @@ namespace vkw {
 
 
 		RegistryManager::RegistryManager():
-			instanceDeleter ([=](VkInstance obj) { vkDestroyInstance(obj, nullptr); }),
-			deviceDeleter([=](VkDevice obj) { vkDestroyDevice(obj, nullptr); }),
 			instance(instance_m),
-			surfaces(surfaces_m)
+			surfaces(surfaces_m),
+			allocationCallbacks(allocationCallbacks_m)
 		{
 		}
 
 		template<> VkObject<VkwInstance>* RegistryManager::getNew() { 
-			VkObject<VkwInstance> * obj = new VkObject<VkwInstance>(instanceDeleter, [](){});
+			VkObject<VkwInstance> * obj = VkObject<VkwInstance>::create();
 			instance_m = obj->getPtr();
 			return obj;
 		}
 
-		template<> VkObject<VkwDevice>* RegistryManager::getNew() { 
-			return new VkObject<VkwDevice>(deviceDeleter, [](){}); 
-		}
-
-		template<> VkObject<VkwSurfaceKHR>* RegistryManager::getNew() { 
-			if (!surfaceDeleter) surfaceDeleter = [=](VkSurfaceKHR obj) {vkDestroySurfaceKHR(instance, obj, nullptr); };
-			return new VkObject<VkwSurfaceKHR>(surfaceDeleter, [](){}); 
-		}
+		template<> VkObject<VkwDevice>* RegistryManager::getNew() { return VkObject<VkwDevice>::create(); }
+		template<> VkObject<VkwSurfaceKHR>* RegistryManager::getNew() { return VkObject<VkwSurfaceKHR>::create(); }
 
 		Registry & RegistryManager::getRegistry()
 		{
 			return *registrys[0];
 		}
 
+		Registry * RegistryManager::getRegistry(VkDevice device)
+		{
+			for (auto x : registrys) if (x->device == device) return x;
+			return nullptr;
+		}
+
 		Registry * RegistryManager::createNewRegistry()
 		{
-			Registry * reg = new Registry(*instance_m);
+			Registry * reg = new Registry(*instance_m, allocationCallbacks_m);
 			registrys.push_back(reg);
 			return reg;
 		}
 
+		void RegistryManager::setAllocationCallbacks(const VkAllocationCallbacks * callbacks)
+		{
+			allocationCallbacks_m = callbacks;
+		}
+
 
 
 		PhysicalDevice::operator VkPhysicalDevice() const
@@ -70,8 +73,9 @@ namespace vkw {
 
 
 	
-		Registry::Registry(const VkInstance & instance):
+		Registry::Registry(const VkInstance & instance, const VkAllocationCallbacks * const & allocationCallbacks):
 			instance(instance),
+			allocationCallbacks(allocationCallbacks),
 			physicalDevice(physicalDevice_m),
 			device(device_m),
 			transferCommandPool(transferCommandPool_m),
@@ -80,7 +84,9 @@ namespace vkw {
 			graphicsQueue(graphicsQueue_m),
 			transferQueue(transferQueue_m),
 			presentQueue(presentQueue_m),
-			computeQueue(computeQueue_m)
+			computeQueue(computeQueue_m),
+			timelineSemaphoreFunctions(timelineSemaphoreFunctions_m),
+			descriptorUpdateTemplateFunctions(descriptorUpdateTemplateFunctions_m)
 		{}
 
 		void Registry::initialize(VkDevice dev, const DeviceQueue & graphics, const DeviceQueue & transfer, const DeviceQueue & present, const DeviceQueue & compute, const PhysicalDevice & gpu)
@@ -92,76 +98,35 @@ namespace vkw {
 			presentQueue_m = present;
 			computeQueue_m = compute;
 
-			fenceDeleter = setDeleterFunction	<VkFence>(vkDestroyFence);
-			semaphoreDeleter = setDeleterFunction	<VkSemaphore>(vkDestroySemaphore);
-			eventDeleter = setDeleterFunction	<VkEvent>(vkDestroyEvent);
-			queryPoolDeleter = setDeleterFunction	<VkQueryPool>(vkDestroyQueryPool);
-			bufferDeleter = setDeleterFunction	<VkBuffer>(vkDestroyBuffer);
-			bufferViewDeleter = setDeleterFunction	<VkBufferView>(vkDestroyBufferView);
-			imageDeleter = setDeleterFunction	<VkImage>(vkDestroyImage);
-			imageViewDeleter = setDeleterFunction	<VkImageView>(vkDestroyImageView);
-			deviceMemoryDeleter = setDeleterFunction	<VkDeviceMemory>(vkFreeMemory);
-			shaderModuleDeleter = setDeleterFunction	<VkShaderModule>(vkDestroyShaderModule);
-			pipelineCacheDeleter = setDeleterFunction	<VkPipelineCache>(vkDestroyPipelineCache);
-			pipelineDeleter = setDeleterFunction	<VkPipeline>(vkDestroyPipeline);
-			pipelineLayoutDeleter = setDeleterFunction	<VkPipelineLayout>(vkDestroyPipelineLayout);
-			samplerDeleter = setDeleterFunction	<VkSampler>(vkDestroySampler);
-			descriptorSetLayoutDeleter = setDeleterFunction	<VkDescriptorSetLayout>(vkDestroyDescriptorSetLayout);
-			descriptorPoolDeleter = setDeleterFunction	<VkDescriptorPool>(vkDestroyDescriptorPool);
-			frameBufferDeleter = setDeleterFunction	<VkFramebuffer>(vkDestroyFramebuffer);
-			renderPassDeleter = setDeleterFunction	<VkRenderPass>(vkDestroyRenderPass);
-			commandPoolDeleter = setDeleterFunction	<VkCommandPool>(vkDestroyCommandPool);
-			swapchainDeleter = setDeleterFunction	<VkSwapchainKHR>(vkDestroySwapchainKHR);
-		}
+			timelineSemaphoreFunctions_m.getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(dev, "vkGetSemaphoreCounterValueKHR");
+			timelineSemaphoreFunctions_m.signalSemaphore = (PFN_vkSignalSemaphoreKHR)vkGetDeviceProcAddr(dev, "vkSignalSemaphoreKHR");
+			timelineSemaphoreFunctions_m.waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(dev, "vkWaitSemaphoresKHR");
 
+			descriptorUpdateTemplateFunctions_m.createDescriptorUpdateTemplate = (PFN_vkCreateDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(dev, "vkCreateDescriptorUpdateTemplateKHR");
+			descriptorUpdateTemplateFunctions_m.updateDescriptorSetWithTemplate = (PFN_vkUpdateDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr(dev, "vkUpdateDescriptorSetWithTemplateKHR");
+			descriptorUpdateTemplateFunctions_m.destroyDescriptorUpdateTemplate = (PFN_vkDestroyDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(dev, "vkDestroyDescriptorUpdateTemplateKHR");
 
-		template<typename T> std::function<void(T)> Registry::setDeleterFunction(std::function<void(T, VkAllocationCallbacks*)> deletef)
-		{
-			return [=](T obj) {deletef(obj, nullptr); };
+			if (!fencePool_m) fencePool_m = new FencePool();
 		}
 
-		template<typename T> std::function<void(T)> Registry::setDeleterFunction(std::function<void(VkInstance, T, VkAllocationCallbacks*)> deletef)
+		FencePool & Registry::fencePool()
 		{
-			return [=](T obj) {deletef(instance, obj, nullptr); };
+			VKW_assert(fencePool_m, "Registry has no device yet");
+			return *fencePool_m;
 		}
 
-		template<typename T> std::function<void(T)> Registry::setDeleterFunction(std::function<void(VkDevice, T, VkAllocationCallbacks*)> deletef)
+		void Registry::destroyFencePool()
 		{
-			return [=](T obj) {deletef(device, obj, nullptr); };
+			delete fencePool_m;
+			fencePool_m = nullptr;
 		}
 
-		template<> std::function<void(VkBuffer)>				 Registry::getDeleter<VkwBuffer>() { return bufferDeleter; }
-		template<> std::function<void(VkBufferView)>			 Registry::getDeleter<VkwBufferView>() { return bufferViewDeleter; }
-		template<> std::function<void(VkCommandPool)>			 Registry::getDeleter<VkwCommandPool>() { return commandPoolDeleter; }
-		template<> std::function<void(VkDescriptorPool)>		 Registry::getDeleter<VkwDescriptorPool>() { return descriptorPoolDeleter; }
-		template<> std::function<void(VkDescriptorSetLayout)>	 Registry::getDeleter<VkwDescriptorSetLayout>() { return descriptorSetLayoutDeleter; }
-		template<> std::function<void(VkDeviceMemory)>			 Registry::getDeleter<VkwDeviceMemory>() { return deviceMemoryDeleter; }
-		template<> std::function<void(VkFence)>					 Registry::getDeleter<VkwFence>() { return fenceDeleter; }
-		template<> std::function<void(VkFramebuffer)>			 Registry::getDeleter<VkwFramebuffer>() { return frameBufferDeleter; }
-		template<> std::function<void(VkEvent)>					 Registry::getDeleter<VkwEvent>() { return eventDeleter; }
-		template<> std::function<void(VkImage)>					 Registry::getDeleter<VkwImage>() { return imageDeleter; }
-		template<> std::function<void(VkImageView)>				 Registry::getDeleter<VkwImageView>() { return imageViewDeleter; }
-		template<> std::function<void(VkPipelineCache)>			 Registry::getDeleter<VkwPipelineCache>() { return pipelineCacheDeleter; }
-		template<> std::function<void(VkPipeline)>				 Registry::getDeleter<VkwPipeline>() { return pipelineDeleter; }
-		template<> std::function<void(VkPipelineLayout)>		 Registry::getDeleter<VkwPipelineLayout>() { return pipelineLayoutDeleter; }
-		template<> std::function<void(VkRenderPass)>			 Registry::getDeleter<VkwRenderPass>() { return renderPassDeleter; }
-		template<> std::function<void(VkSampler)>				 Registry::getDeleter<VkwSampler>() { return samplerDeleter; }
-		template<> std::function<void(VkSemaphore)>				 Registry::getDeleter<VkwSemaphore>() { return semaphoreDeleter; }
-		template<> std::function<void(VkShaderModule)>			 Registry::getDeleter<VkwShaderModule>() { return shaderModuleDeleter; }
-		template<> std::function<void(VkSurfaceKHR)>			 Registry::getDeleter<VkwSurfaceKHR>() { return surfaceDeleter; }
-		template<> std::function<void(VkSwapchainKHR)>			 Registry::getDeleter<VkwSwapchainKHR>() { return swapchainDeleter; }
-		template<> std::function<void(VkQueryPool)>				 Registry::getDeleter<VkwQueryPool>() { return queryPoolDeleter; }
 
-		template<> std::function<void(VkCommandPool)>			 Registry::getDeleter<VkwGraphicsCommandPool>() { return commandPoolDeleter; }
-		template<> std::function<void(VkCommandPool)>			 Registry::getDeleter<VkwTransferCommandPool>() { return commandPoolDeleter; }
-		template<> std::function<void(VkCommandPool)>			 Registry::getDeleter<VkwComputeCommandPool>() { return commandPoolDeleter; }
-
-		template<typename T> std::function<void(typename T::Type)>	Registry::getDeleter() { return std::function<void(typename T::Type)>(0); }
-
-		template<typename T> VkObject<T> * Registry::create() { return new VkObject<T>(getDeleter<T>(), std::function<void(void)> (0)); }
+		template<typename T> VkObject<T> * Registry::create() { return VkObject<T>::create(); }
 
 		template<typename T> VkObject<T> * Registry::create(typename T::Type *& object) { 
-			VkObject<T> * obj = new VkObject<T>(getDeleter<T>(), [&]() { object = nullptr; });
+			VkObject<T> * obj = VkObject<T>::create();
+			obj->tracker = &object;
 			object = obj->getPtr();
 			return obj;
 		}
@@ -180,58 +145,237 @@ namespace vkw {
 
 		
 
-		/// Vk Object
-		template<typename T> VkObject<T>::VkObject(std::function<void(Type)> & delf, std::function<void(void)> callback):
-			deleterCallback(callback),
-			deleterFunc(delf)
-		{}
+		/// Deleters
+		template<> void destroyHandle<VkwInstance>(RegistryManager & reg, VkInstance obj, const NoParent &) { vkDestroyInstance(obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwDevice>(RegistryManager & reg, VkDevice obj, const NoParent &) {
+			Registry * registry = reg.getRegistry(obj);
+			if (registry) {
+				registry->destroyFencePool();
+				registry->flushDeletionQueue();
+			}
+			vkDestroyDevice(obj, reg.allocationCallbacks);
+		}
+		template<> void destroyHandle<VkwSurfaceKHR>(RegistryManager & reg, VkSurfaceKHR obj, const NoParent &) { vkDestroySurfaceKHR(reg.instance, obj, nullptr); } // the Window creates surfaces without allocation callbacks
+
+		template<> void destroyHandle<VkwBuffer>(Registry & reg, VkBuffer obj, const NoParent &) { vkDestroyBuffer(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwCommandBuffer>(Registry & reg, VkCommandBuffer obj, const VkCommandPool & pool) { if (pool != VK_NULL_HANDLE) vkFreeCommandBuffers(reg.device, pool, 1, &obj); }
+		template<> void destroyHandle<VkwCommandPool>(Registry & reg, VkCommandPool obj, const NoParent &) { vkDestroyCommandPool(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwDescriptorPool>(Registry & reg, VkDescriptorPool obj, const NoParent &) { vkDestroyDescriptorPool(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwDescriptorSetLayout>(Registry & reg, VkDescriptorSetLayout obj, const NoParent &) { vkDestroyDescriptorSetLayout(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwDescriptorSet>(Registry & reg, VkDescriptorSet obj, const NoParent &) {} // freed with its pool
+		template<> void destroyHandle<VkwDescriptorUpdateTemplate>(Registry & reg, VkDescriptorUpdateTemplate obj, const NoParent &) {
+			VKW_assert(reg.descriptorUpdateTemplateFunctions.destroyDescriptorUpdateTemplate, "VK_KHR_descriptor_update_template is not enabled");
+			reg.descriptorUpdateTemplateFunctions.destroyDescriptorUpdateTemplate(reg.device, obj, reg.allocationCallbacks);
+		}
+		template<> void destroyHandle<VkwDeviceMemory>(Registry & reg, VkDeviceMemory obj, const NoParent &) { vkFreeMemory(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwFence>(Registry & reg, VkFence obj, const NoParent &) { vkDestroyFence(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwFramebuffer>(Registry & reg, VkFramebuffer obj, const NoParent &) { vkDestroyFramebuffer(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwImage>(Registry & reg, VkImage obj, const NoParent &) { vkDestroyImage(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwImageView>(Registry & reg, VkImageView obj, const NoParent &) { vkDestroyImageView(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwPhysicalDevice>(Registry & reg, VkPhysicalDevice obj, const NoParent &) {} // owned by the instance
+		template<> void destroyHandle<VkwPipelineCache>(Registry & reg, VkPipelineCache obj, const NoParent &) { vkDestroyPipelineCache(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwPipeline>(Registry & reg, VkPipeline obj, const NoParent &) { vkDestroyPipeline(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwPipelineLayout>(Registry & reg, VkPipelineLayout obj, const NoParent &) { vkDestroyPipelineLayout(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwRenderPass>(Registry & reg, VkRenderPass obj, const NoParent &) { vkDestroyRenderPass(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwSampler>(Registry & reg, VkSampler obj, const NoParent &) { vkDestroySampler(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwSemaphore>(Registry & reg, VkSemaphore obj, const NoParent &) { vkDestroySemaphore(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwShaderModule>(Registry & reg, VkShaderModule obj, const NoParent &) { vkDestroyShaderModule(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwSwapchainKHR>(Registry & reg, VkSwapchainKHR obj, const NoParent &) { vkDestroySwapchainKHR(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwGraphicsCommandPool>(Registry & reg, VkCommandPool obj, const NoParent &) { vkDestroyCommandPool(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwTransferCommandPool>(Registry & reg, VkCommandPool obj, const NoParent &) { vkDestroyCommandPool(reg.device, obj, reg.allocationCallbacks); }
+		template<> void destroyHandle<VkwComputeCommandPool>(Registry & reg, VkCommandPool obj, const NoParent &) { vkDestroyCommandPool(reg.device, obj, reg.allocationCallbacks); }
+
+		// objects of the instance level are never deferred
+		template<typename T> void retireHandle(RegistryManager & reg, typename T::Type obj, const typename ParentOf<T>::Type & parent) { destroyHandle<T>(reg, obj, parent); }
+		template<typename T> void retireHandle(Registry & reg, typename T::Type obj, const typename ParentOf<T>::Type & parent) { reg.destroyDeferred<T>(obj, parent); }
+
+
+
+
+
+		/// Deferred Destruction
+		template<typename T> static void destroyPendingHandle(Registry & reg, uint64_t object, uint64_t parent)
+		{
+			destroyHandle<T>(reg, tools::bitsToHandle<typename T::Type>(object), tools::bitsToHandle<typename ParentOf<T>::Type>(parent));
+		}
 
-		template<typename T> VkObject<T>::~VkObject()
+		template<typename T> void Registry::destroyDeferred(typename T::Type object, const typename ParentOf<T>::Type & parent)
 		{
-			if (deleterCallback) deleterCallback();
+			{
+				std::lock_guard<std::mutex> lock(deletionMutex_m);
+				if (deferDestruction_m) {
+					currentFrame_m.push_back({ &destroyPendingHandle<T>, tools::handleToBits(object), tools::handleToBits(parent) });
+					return;
+				}
+			}
+
+			destroyHandle<T>(*this, object, parent);
 		}
 
-		template<typename T> void VkObject<T>::add(VkObject<T> *& ref) {
-			references.push_back(&ref);
+		void Registry::releaseDeferred(ReleaseFunction release, void * context, uint64_t offset, uint64_t size)
+		{
+			{
+				std::lock_guard<std::mutex> lock(deletionMutex_m);
+				if (deferDestruction_m) {
+					currentReleases_m.push_back({ release, context, offset, size });
+					return;
+				}
+			}
+
+			release(context, offset, size);
 		}
 
-		template<typename T> void VkObject<T>::remove(VkObject<T> *& ref, std::function<void(Type)> deleterf) {
-			references.erase(std::remove(references.begin(), references.end(), &ref), references.end());
-			ref = nullptr;
+		void Registry::cancelReleases(const void * context)
+		{
+			auto ofContext = [context](const PendingRelease & x) { return x.context == context; };
 
-			if (references.size() == 0) {
-				if (object != VK_NULL_HANDLE) {
-					if (deleterf) deleterf(object);
-					else if (deleterFunc) deleterFunc(object);
-				}
+			std::lock_guard<std::mutex> lock(deletionMutex_m);
+			currentReleases_m.erase(std::remove_if(currentReleases_m.begin(), currentReleases_m.end(), ofContext), currentReleases_m.end());
+			for (auto & x : retiredFrames_m) x.releases.erase(std::remove_if(x.releases.begin(), x.releases.end(), ofContext), x.releases.end());
+		}
 
-				delete this;
-			}
+		void Registry::setDeferredDestruction(bool enable)
+		{
+			std::lock_guard<std::mutex> lock(deletionMutex_m);
+			deferDestruction_m = enable;
 		}
 
-		template<typename T> void VkObject<T>::deleteThis(std::function<void(Type)> deleterf)
+		void Registry::endFrame(VkFence fence)
 		{
-			if (object != VK_NULL_HANDLE) {
-				if (deleterf != 0) {
-					deleterf(object);
-				}
-				else if (deleterFunc != 0) {
-					deleterFunc(object);
+			RetiredFrame frame;
+			frame.fence = fence;
+			retireFrame(std::move(frame));
+		}
+
+		void Registry::endFrame(VkSemaphore timelineSemaphore, uint64_t value)
+		{
+			RetiredFrame frame;
+			frame.timelineSemaphore = timelineSemaphore;
+			frame.value = value;
+			retireFrame(std::move(frame));
+		}
+
+		void Registry::retireFrame(RetiredFrame && frame)
+		{
+			{
+				std::lock_guard<std::mutex> lock(deletionMutex_m);
+
+				// a frame without releases needs no entry, the frames before it are checked on their own
+				if (!currentFrame_m.empty() || !currentReleases_m.empty()) {
+					frame.destructions.swap(currentFrame_m);
+					frame.releases.swap(currentReleases_m);
+					retiredFrames_m.push_back(std::move(frame));
+
+					if (!spareLists_m.empty()) {
+						currentFrame_m.swap(spareLists_m.back());
+						spareLists_m.pop_back();
+					}
 				}
+			}
+
+			collectGarbage();
+		}
 
-				object = VK_NULL_HANDLE;
+		bool Registry::isFinished(const RetiredFrame & frame)
+		{
+			if (frame.fence != VK_NULL_HANDLE) return vkGetFenceStatus(device_m, frame.fence) == VK_SUCCESS;
+
+			VKW_assert(timelineSemaphoreFunctions_m.getSemaphoreCounterValue, "VK_KHR_timeline_semaphore is not enabled");
+
+			uint64_t value = 0;
+			Debug::errorCodeCheck(timelineSemaphoreFunctions_m.getSemaphoreCounterValue(device_m, frame.timelineSemaphore, &value), "Failed to read the timeline semaphore value");
+			return value >= frame.value;
+		}
+
+		void Registry::destroyPending(std::vector<PendingDestruction> & destructions, std::vector<PendingRelease> & releases)
+		{
+			for (auto & x : destructions) x.destroy(*this, x.object, x.parent);
+			destructions.clear();
+
+			for (auto & x : releases) x.release(x.context, x.offset, x.size);
+			releases.clear();
+		}
+
+		void Registry::collectGarbage()
+		{
+			std::lock_guard<std::mutex> lock(deletionMutex_m);
+
+			// queues finish their frames in order, the first unfinished frame ends the search
+			while (!retiredFrames_m.empty() && isFinished(retiredFrames_m.front())) {
+				destroyPending(retiredFrames_m.front().destructions, retiredFrames_m.front().releases);
+				spareLists_m.push_back(std::move(retiredFrames_m.front().destructions));
+				retiredFrames_m.pop_front();
 			}
+		}
+
+		void Registry::flushDeletionQueue()
+		{
+			std::lock_guard<std::mutex> lock(deletionMutex_m);
+			if (retiredFrames_m.empty() && currentFrame_m.empty() && currentReleases_m.empty()) return;
+
+			vkDeviceWaitIdle(device_m);
 
-			for (auto x : references) {
-				*x = nullptr;
+			for (auto & x : retiredFrames_m) destroyPending(x.destructions, x.releases);
+			retiredFrames_m.clear();
+			destroyPending(currentFrame_m, currentReleases_m);
+		}
+
+		size_t Registry::pendingDestructionCount() const
+		{
+			std::lock_guard<std::mutex> lock(deletionMutex_m);
+
+			size_t count = currentFrame_m.size() + currentReleases_m.size();
+			for (auto & x : retiredFrames_m) count += x.destructions.size() + x.releases.size();
+			return count;
+		}
+
+
+
+
+
+		/// Vk Object
+		template<typename T> thread_local VkObject<T> * VkObject<T>::freeList = nullptr;
+
+		template<typename T> VkObject<T> * VkObject<T>::create()
+		{
+			if (!freeList) {
+				// nodes are never given back to the system, Base objects may outlive every static destructor
+				VkObject<T> * chunk = new VkObject<T>[chunkSize];
+				for (size_t i = 0; i < chunkSize - 1; i++) chunk[i].nextFree = &chunk[i + 1];
+				freeList = chunk;
 			}
 
-			delete this;
+			VkObject<T> * obj = freeList;
+			freeList = obj->nextFree;
+
+			obj->nextFree = nullptr;
+			obj->references.store(1, std::memory_order_relaxed);
+			return obj;
 		}
 
-		template<typename T> uint32_t VkObject<T>::referenceCount()
+		template<typename T> void VkObject<T>::recycle()
 		{
-			return static_cast<uint32_t>(references.size());
+			if (tracker && *tracker == &object) *tracker = nullptr;
+
+			object = VK_NULL_HANDLE;
+			parent = {};
+			tracker = nullptr;
+
+			nextFree = freeList;
+			freeList = this;
+		}
+
+		template<typename T> void VkObject<T>::addReference() {
+			references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		template<typename T> bool VkObject<T>::release() {
+			return references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		}
+
+		template<typename T> uint32_t VkObject<T>::referenceCount() const
+		{
+			return references.load(std::memory_order_relaxed);
 		}
 
 		template<typename T> typename T::Type * VkObject<T>::getPtr()
@@ -239,12 +383,12 @@ namespace vkw {
 			return &object;
 		}
 
-		template<class T> typename T::Type VkObject<T>::getObj()
+		template<class T> typename T::Type VkObject<T>::getObj() const
 		{
 			return object;
 		}
 
-		template<typename T> VkObject<T>::operator typename T::Type()
+		template<typename T> VkObject<T>::operator typename T::Type() const
 		{
 			return object;
 		}
@@ -258,83 +402,84 @@ namespace vkw {
 
 		
 		/// Vk Pointer
-		template<typename T, typename RegType> VkPointer<T, RegType>::VkPointer(RegType & reg, DestructionControl & destrContr, std::function<void(Type)> deleterf) :
+		template<typename T, typename RegType> VkPointer<T, RegType>::VkPointer(RegType & reg, DestructionControl & destrContr) :
 			registry(reg),
-			destructionControl(destrContr),
-			deleterFunc(deleterf)
+			destructionControl(destrContr)
 		{}
 
-		template<typename T, typename RegType> VkPointer<T, RegType>::VkPointer(const VkPointer<T, RegType> & obj) :
-			pObject(obj.pObject),
-			registry(obj.registry),
-			destructionControl(obj.destructionControl),
-			deleterFunc(obj.deleterFunc)
-		{
-			if (!pObject) {
-				pObject = registry.getNew<T>();
-				obj.pObject = pObject;
-				pObject->add(pObject);
-				obj.pObject->add(obj.pObject);
-			}
-			else {
-				pObject->add(pObject);
-			}
+		template<typename T, typename RegType> void VkPointer<T, RegType>::copy(const VkPointer<T, RegType> & obj)
+		{
+			if (pObject == obj.pObject) return;
+
+			if (obj.pObject) obj.pObject->addReference();
+			release();
+			pObject = obj.pObject;
 		}
 
-		template<typename T, typename RegType> void VkPointer<T, RegType>::copy(const VkPointer<T, RegType> & obj)
+		template<typename T, typename RegType> void VkPointer<T, RegType>::move(VkPointer<T, RegType> & obj) noexcept
 		{
-			deleterFunc = obj.deleterFunc;
+			if (this == &obj) return;
 
-			if(pObject) pObject->remove(pObject, deleterFunc);
+			release();
 			pObject = obj.pObject;
-			if(pObject) pObject->add(pObject); 
+			obj.pObject = nullptr;
 		}
 
 		template<typename T, typename RegType> void VkPointer<T, RegType>::destroyObject() // gets called manually
 		{
-			if (pObject) {
-				if (destructionControl == VKW_DESTR_CONTRL_FIRST_OBJECT_CALLS_DELETER ||
-					destructionControl == VKW_DESTR_CONTRL_EXCLUSIVE_DELETER_CALL ||
-					destructionControl == VKW_DESTR_CONTRL_LAST_OBJECT_CALLS_DELETER && pObject->referenceCount() <= 1)
-				{
-					pObject->deleteThis(deleterFunc); // pObject set to nullptr automatically
-				}
-				else {
-					pObject->remove(pObject, deleterFunc); // pObject set to nullptr automatically
-				}
+			if (!pObject) return;
+
+			if (destructionControl == VKW_DESTR_CONTRL_FIRST_OBJECT_CALLS_DELETER ||
+				destructionControl == VKW_DESTR_CONTRL_EXCLUSIVE_DELETER_CALL)
+			{
+				// the other references keep the node but see VK_NULL_HANDLE
+				Type object = pObject->getObj();
+				if (object != VK_NULL_HANDLE) retireHandle<T>(registry, object, pObject->parent);
+				*pObject = VK_NULL_HANDLE;
 			}
+
+			release();
 		}
 
-		template<typename T, typename RegType> void VkPointer<T, RegType>::operator = (Type rhs) {
-			if (!pObject) {
-				pObject = registry.getNew<T>();
-				pObject->add(pObject);
+		template<typename T, typename RegType> bool VkPointer<T, RegType>::destroysObject() const
+		{
+			if (!pObject || pObject->getObj() == VK_NULL_HANDLE) return false;
+
+			return destructionControl == VKW_DESTR_CONTRL_FIRST_OBJECT_CALLS_DELETER ||
+				destructionControl == VKW_DESTR_CONTRL_EXCLUSIVE_DELETER_CALL ||
+				pObject->referenceCount() == 1;
+		}
+
+		template<typename T, typename RegType> void VkPointer<T, RegType>::release()
+		{
+			if (!pObject) return;
+
+			if (pObject->release()) {
+				Type object = pObject->getObj();
+				if (object != VK_NULL_HANDLE) retireHandle<T>(registry, object, pObject->parent);
+				pObject->recycle();
 			}
+
+			pObject = nullptr;
+		}
+
+		template<typename T, typename RegType> void VkPointer<T, RegType>::operator = (Type rhs) {
+			if (!pObject) pObject = registry.template getNew<T>();
 			*pObject = rhs;
 		}
 
 		template<typename T, typename RegType> typename T::Type * VkPointer<T, RegType>::createNew()
 		{
-			if (!pObject) {
-				pObject = registry.getNew<T>();
-				pObject->add(pObject);
-			}
-			else {
-				destroyObject();
-				pObject = registry.getNew<T>();
-			}
+			destroyObject();
+			pObject = registry.template getNew<T>();
 
 			return pObject->getPtr();
 		}
 
-	/*	template<typename T, typename RegType> VkPointer<T, RegType>& VkPointer<T, RegType>::operator=(VkPointer<T, RegType>& rhs)
+		template<typename T, typename RegType> void VkPointer<T, RegType>::setParent(const Parent & parent)
 		{
-			rhs.pObject->add(pObject);
-			pObject = rhs.pObject;
-			rhs.pObject->remove(rhs.pObject);
-
-			return *this;
-		}*/
+			if (pObject) pObject->parent = parent;
+		}
 
 		template<typename T, typename RegType> VkPointer<T, RegType>::operator Type*() const // "() op" -> return ptr
 		{
@@ -357,17 +502,29 @@ namespace vkw {
 
 
 		/// Vk Object
-		template<typename T, typename RegType> Base<T, RegType>::Base(std::function<void(Type)> deleterf) :
+		template<typename T, typename RegType> Base<T, RegType>::Base() :
 			registry(getRegistry<RegType>()),
-			pVkObject(registry, destructionControl, deleterf)
+			pVkObject(registry, destructionControl)
 		{}
 
 		template<typename T, typename RegType> Base<T, RegType>::Base(const Base<T, RegType> & rhs):
+			destructionControl((rhs.destructionControl == VKW_DESTR_CONTRL_EXCLUSIVE_DELETER_CALL && rhs.passOnVkObject) ? VKW_DESTR_CONTRL_DO_NOTHING : rhs.destructionControl),
+			passOnVkObject(rhs.passOnVkObject),
 			registry(rhs.registry),
-			pVkObject(rhs.pVkObject),
+			pVkObject(registry, destructionControl)
+		{
+			pVkObject.copy(rhs.pVkObject);
+		}
+
+		// the node changes owner without touching its reference count, so the destruction control moves along with it
+		template<typename T, typename RegType> Base<T, RegType>::Base(Base<T, RegType> && rhs) noexcept :
+			destructionControl(rhs.destructionControl),
 			passOnVkObject(rhs.passOnVkObject),
-			destructionControl((rhs.destructionControl == VKW_DESTR_CONTRL_EXCLUSIVE_DELETER_CALL && passOnVkObject) ? VKW_DESTR_CONTRL_DO_NOTHING : rhs.destructionControl)
-		{}
+			registry(rhs.registry),
+			pVkObject(registry, destructionControl)
+		{
+			pVkObject.move(rhs.pVkObject);
+		}
 		
 		template<typename T, typename RegType> Base<T, RegType>::~Base()
 		{
@@ -387,15 +544,16 @@ namespace vkw {
 			return *this;
 		}
 
-	/*	template<typename T, typename RegType> Base<T, RegType>& Base<T, RegType>::operator=(Base<T, RegType>&& rhs)
+		template<typename T, typename RegType> Base<T, RegType> & Base<T, RegType>::operator = (Base<T, RegType> && rhs) noexcept
 		{
-			passOnVkObject = true;
-			DestructionControl destructionControl = VKW_DESTR_CONTRL_LAST_OBJECT_CALLS_DELETER;
+			if (this == &rhs) return *this;
 
-			std::swap(vkObject, rhs.vkObject);
+			pVkObject.move(rhs.pVkObject);
+			passOnVkObject = rhs.passOnVkObject;
+			destructionControl = rhs.destructionControl;
 
 			return *this;
-		}*/
+		}
 
 		template<typename T, typename RegType> void Base<T, RegType>::destroyObject()
 		{
@@ -424,6 +582,7 @@ namespace vkw {
 		template class VkObject<VkwDescriptorPool>;
 		template class VkObject<VkwDescriptorSetLayout>;
 		template class VkObject<VkwDescriptorSet>;
+		template class VkObject<VkwDescriptorUpdateTemplate>;
 		template class VkObject<VkwDevice>;
 		template class VkObject<VkwDeviceMemory>;
 		template class VkObject<VkwFence>;
@@ -456,6 +615,7 @@ namespace vkw {
 		template class VkPointer<VkwDescriptorPool, Registry>;
 		template class VkPointer<VkwDescriptorSetLayout, Registry>;
 		template class VkPointer<VkwDescriptorSet, Registry>;
+		template class VkPointer<VkwDescriptorUpdateTemplate, Registry>;
 		template class VkPointer<VkwDeviceMemory, Registry>;
 		template class VkPointer<VkwFence, Registry>;
 		template class VkPointer<VkwFramebuffer, Registry>;
@@ -485,6 +645,7 @@ namespace vkw {
 		template class Base<VkwDescriptorPool, Registry>;
 		template class Base<VkwDescriptorSetLayout, Registry>;
 		template class Base<VkwDescriptorSet, Registry>;
+		template class Base<VkwDescriptorUpdateTemplate, Registry>;
 		template class Base<VkwDeviceMemory, Registry>;
 		template class Base<VkwFence, Registry>;
 		template class Base<VkwFramebuffer, Registry>;
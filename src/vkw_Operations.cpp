@@ -23,7 +23,7 @@ namespace vkw {
 		info.queueFamilyIndex = queueFamily;
 		info.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Command Pool");
+		vkw::Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Command Pool");
 	}
 
 	void CommandPool::createCommandPool(uint32_t queueFamily, VkCommandPoolCreateFlags flags)
@@ -34,6 +34,11 @@ namespace vkw {
 		createCommandPool(createInfo);
 	}
 
+	void CommandPool::reset(VkCommandPoolResetFlags flags)
+	{
+		vkw::Debug::errorCodeCheck(vkResetCommandPool(registry.device, *pVkObject, flags), "Failed to reset Command Pool");
+	}
+
 
 
 
@@ -65,6 +70,7 @@ namespace vkw {
 			commandBuffers[i].commandPool_m = commandPool;
 			commandBuffers[i].level = level;
 			commandBuffers[i].pVkObject = vkCommandBuffers[i];
+			commandBuffers[i].pVkObject.setParent(commandPool); // freed from this pool
 		}
 	}
 
@@ -83,14 +89,11 @@ namespace vkw {
 			commandBuffers[i].get().commandPool_m = commandPool;
 			commandBuffers[i].get().level = level;
 			commandBuffers[i].get().pVkObject = vkCommandBuffers[i];
+			commandBuffers[i].get().pVkObject.setParent(commandPool); // freed from this pool
 		}
 	}
 
 	CommandBuffer::CommandBuffer():
-		Base([&](VkCommandBuffer obj) {
-		if (commandPool != VK_NULL_HANDLE)
-			vkFreeCommandBuffers(registry.device, commandPool_m, 1, &obj);
-		}),
 		commandPool(commandPool_m)
 	{
 		//destructionControl = VKW_DESTR_CONTRL_DO_NOTHING; // review if this should be set or not
@@ -109,16 +112,17 @@ namespace vkw {
 
 	void CommandBuffer::allocateCommandBuffer(const AllocInfo & allocInfo)
 	{
-		this->level = level;
+		this->level = allocInfo.level;
 		this->commandPool_m = allocInfo.commandPool;
 
 		VkCommandBufferAllocateInfo info = init::commandBufferAllocateInfo();
-		info.level = level;
+		info.level = allocInfo.level;
 		info.commandPool = allocInfo.commandPool;
 		info.commandBufferCount = 1;
 		info.pNext = allocInfo.pNext;
 
 		vkw::Debug::errorCodeCheck(vkAllocateCommandBuffers(registry.device, &info, pVkObject.createNew()), "Failed to allocate Command Buffer");
+		pVkObject.setParent(allocInfo.commandPool);
 	}
 
 	void CommandBuffer::allocateCommandBuffer(VkCommandPool commandPool, VkCommandBufferLevel level)
@@ -129,6 +133,34 @@ namespace vkw {
 		allocateCommandBuffer(allocInfo);
 	}
 
+	CommandBuffer::CommandBuffer(const CommandBuffer & rhs) : CommandBuffer()
+	{
+		*this = rhs;
+	}
+
+	CommandBuffer::CommandBuffer(CommandBuffer && rhs) noexcept : CommandBuffer()
+	{
+		*this = std::move(rhs);
+	}
+
+	CommandBuffer & CommandBuffer::operator=(const CommandBuffer & rhs)
+	{
+		impl::Object<impl::VkwCommandBuffer>::operator=(rhs);
+		level = rhs.level;
+		commandPool_m = rhs.commandPool_m;
+
+		return *this;
+	}
+
+	CommandBuffer & CommandBuffer::operator=(CommandBuffer && rhs) noexcept
+	{
+		impl::Object<impl::VkwCommandBuffer>::operator=(std::move(rhs));
+		level = rhs.level;
+		commandPool_m = rhs.commandPool_m;
+
+		return *this;
+	}
+
 	void CommandBuffer::freeCommandBuffer()
 	{
 		pVkObject.destroyObject();
@@ -143,6 +175,22 @@ namespace vkw {
 		vkw::Debug::errorCodeCheck(vkBeginCommandBuffer(*pVkObject, &beginInfo), "Failed to start recording of the Command Buffer");
 	}
 
+	void CommandBuffer::beginSecondary(VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer, VkCommandBufferUsageFlags flags)
+	{
+		VkCommandBufferInheritanceInfo inheritanceInfo = init::commandBufferInheritanceInfo();
+		inheritanceInfo.renderPass = renderPass;
+		inheritanceInfo.subpass = subpass;
+		inheritanceInfo.framebuffer = frameBuffer;
+
+		beginCommandBuffer(flags | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritanceInfo);
+	}
+
+	void CommandBuffer::executeCommands(const std::vector<VkCommandBuffer> & secondaryCommandBuffers)
+	{
+		if (secondaryCommandBuffers.empty()) return;
+		vkCmdExecuteCommands(*pVkObject, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+	}
+
 	void CommandBuffer::endCommandBuffer()
 	{
 		vkw::Debug::errorCodeCheck(vkEndCommandBuffer(*pVkObject), "Failed to record command Buffer!");
@@ -152,7 +200,7 @@ namespace vkw {
 		vkw::Debug::errorCodeCheck(vkResetCommandBuffer(*pVkObject, flags), "Failed to reset command Buffer!");
 	}
 
-	void CommandBuffer::submitCommandBuffer(VkQueue queue, std::vector<VkSemaphore> semaphore, VkFence fence)
+	void CommandBuffer::submitCommandBuffer(VkQueue queue, const std::vector<VkSemaphore> & semaphore, VkFence fence)
 	{
 		VkSubmitInfo submitInfo = init::submitInfo();
 		submitInfo.commandBufferCount = 1;
@@ -163,6 +211,44 @@ namespace vkw {
 		vkw::Debug::errorCodeCheck(vkQueueSubmit(queue, 1, &submitInfo, fence), "Failed to submit Command Buffer");
 	}
 
+	void CommandBuffer::submitCommandBuffer(VkQueue queue, const std::vector<VkSemaphore> & waitSemaphores, const std::vector<VkPipelineStageFlags> & waitStages, const std::vector<VkSemaphore> & signalSemaphores, VkFence fence)
+	{
+		VKW_assert(waitSemaphores.size() == waitStages.size(), "Every wait semaphore needs a stage mask");
+
+		VkSubmitInfo submitInfo = init::submitInfo();
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = pVkObject;
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		vkw::Debug::errorCodeCheck(vkQueueSubmit(queue, 1, &submitInfo, fence), "Failed to submit Command Buffer");
+	}
+
+
+
+
+
+	void CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+	{
+		vkCmdDispatch(*pVkObject, groupCountX, groupCountY, groupCountZ);
+	}
+
+	void CommandBuffer::dispatchThreads(uint32_t threadCountX, uint32_t threadCountY, uint32_t threadCountZ, uint32_t localSizeX, uint32_t localSizeY, uint32_t localSizeZ)
+	{
+		dispatch(
+			(threadCountX + localSizeX - 1) / localSizeX,
+			(threadCountY + localSizeY - 1) / localSizeY,
+			(threadCountZ + localSizeZ - 1) / localSizeZ
+		);
+	}
+
+	void CommandBuffer::dispatchIndirect(VkBuffer buffer, VkDeviceSize offset)
+	{
+		vkCmdDispatchIndirect(*pVkObject, buffer, offset);
+	}
 
 
 
@@ -184,7 +270,7 @@ namespace vkw {
 		info.queueFamilyIndex = createInfo.queueFamilyIndex == VKW_DEFAULT_QUEUE ? registry.transferQueue.family : createInfo.queueFamilyIndex;
 		info.pNext = info.pNext;
 
-		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Transfer Command Pool");
+		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Transfer Command Pool");
 	}
 
 	void TransferCommandPool::createTransferCommandPool(int queueFamilyIndex)
@@ -213,7 +299,7 @@ namespace vkw {
 		info.queueFamilyIndex = createInfo.queueFamilyIndex == VKW_DEFAULT_QUEUE ? registry.graphicsQueue.family : createInfo.queueFamilyIndex;
 		info.pNext = info.pNext;
 
-		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Transfer Command Pool");
+		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Transfer Command Pool");
 	}
 
 	void GraphicsCommandPool::createGraphicsCommandPool(int queueFamilyIndex)
@@ -242,7 +328,7 @@ namespace vkw {
 		info.queueFamilyIndex = createInfo.queueFamilyIndex == VKW_DEFAULT_QUEUE ? registry.computeQueue.family : createInfo.queueFamilyIndex;
 		info.pNext = info.pNext;
 
-		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Transfer Command Pool");
+		Debug::errorCodeCheck(vkCreateCommandPool(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Transfer Command Pool");
 	}
 
 	void ComputeCommandPool::createComputeCommandPool(int queueFamilyIndex)
@@ -252,5 +338,864 @@ namespace vkw {
 		createComputeCommandPool(createInfo);
 	}
 
-}
 
+
+
+
+	/// Command Pool Manager
+	CommandPoolManager::CommandPoolManager(uint32_t queueFamily, uint32_t frameCount) :
+		queueFamily(queueFamily_m),
+		frameCount(frameCount_m),
+		frameIndex(frameIndex_m),
+		queueFamily_m(queueFamily),
+		frameCount_m(std::max(frameCount, 1u))
+	{}
+
+	CommandPoolManager::CommandPoolManager(const CreateInfo & createInfo) :
+		CommandPoolManager(createInfo.queueFamily, createInfo.frameCount)
+	{}
+
+	CommandBuffer & CommandPoolManager::getCommandBuffer(VkCommandBufferLevel level)
+	{
+		FramePool & pool = framePool();
+
+		std::deque<CommandBuffer> & commandBuffers = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? pool.primary : pool.secondary;
+		size_t & used = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? pool.usedPrimary : pool.usedSecondary;
+
+		if (used == commandBuffers.size()) commandBuffers.emplace_back(pool.commandPool, level); // deque keeps references to handed out buffers valid
+		VKW_assert(commandBuffers[used].level == level, "CommandPoolManager handed out a command buffer of the wrong level");
+		return commandBuffers[used++];
+	}
+
+	VkCommandPool CommandPoolManager::getCommandPool()
+	{
+		return framePool().commandPool;
+	}
+
+	void CommandPoolManager::nextFrame()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		frameIndex_m = (frameIndex_m + 1) % frameCount_m;
+		for (auto & x : threadPools) {
+			FramePool & pool = x.second.at(frameIndex_m);
+			pool.commandPool.reset();
+			pool.usedPrimary = 0;
+			pool.usedSecondary = 0;
+		}
+	}
+
+	CommandPoolManager::FramePool & CommandPoolManager::framePool()
+	{
+		std::lock_guard<std::mutex> lock(mutex); // only guards the map, the pools themselves are used by one thread only
+
+		std::vector<FramePool> & pools = threadPools[std::this_thread::get_id()];
+		if (pools.empty()) {
+			pools.resize(frameCount_m);
+			for (auto & x : pools) x.commandPool.createCommandPool(queueFamily_m, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}
+
+		return pools.at(frameIndex_m);
+	}
+
+
+
+
+	/// Parallel Encoder
+	ParallelEncoder::ParallelEncoder(CommandPoolManager & commandPools, uint32_t threadCount) :
+		threadCount(threadCount_m),
+		commandPools(commandPools),
+		threadCount_m(std::max(threadCount, 1u))
+	{
+		for (uint32_t i = 0; i < threadCount_m; i++) workers.emplace_back(&ParallelEncoder::workerLoop, this, i);
+	}
+
+	ParallelEncoder::~ParallelEncoder()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		workAvailable.notify_all();
+		for (auto & x : workers) x.join();
+	}
+
+	std::vector<VkCommandBuffer> ParallelEncoder::encode(uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer, const RecordFunction & record)
+	{
+		uint32_t chunkCount = std::min(threadCount_m, itemCount);
+		if (chunkCount == 0) return {};
+
+		std::vector<VkCommandBuffer> secondaries(chunkCount);
+		uint32_t chunkSize = itemCount / chunkCount;
+		uint32_t remainder = itemCount % chunkCount;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		task = [&](uint32_t worker) {
+			if (worker >= chunkCount) return;
+
+			// the first chunks get one item more if the items don't divide evenly
+			uint32_t first = worker * chunkSize + std::min(worker, remainder);
+			uint32_t count = chunkSize + (worker < remainder ? 1 : 0);
+
+			CommandBuffer & commandBuffer = commandPools.getCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+			VKW_assert(commandBuffer.level == VK_COMMAND_BUFFER_LEVEL_SECONDARY, "ParallelEncoder can only record into secondary command buffers");
+			commandBuffer.beginSecondary(renderPass, subpass, frameBuffer);
+			record(commandBuffer, first, count);
+			commandBuffer.endCommandBuffer();
+
+			secondaries[worker] = commandBuffer;
+		};
+		pending = threadCount_m;
+		generation++;
+		workAvailable.notify_all();
+		workDone.wait(lock, [this]() { return pending == 0; });
+		task = nullptr;
+
+		return secondaries;
+	}
+
+	void ParallelEncoder::encode(VkCommandBuffer primaryCommandBuffer, uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer frameBuffer, const RecordFunction & record)
+	{
+		std::vector<VkCommandBuffer> secondaries = encode(itemCount, renderPass, subpass, frameBuffer, record);
+		if (!secondaries.empty()) vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+	}
+
+	void ParallelEncoder::workerLoop(uint32_t worker)
+	{
+		uint64_t seenGeneration = 0;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			workAvailable.wait(lock, [&]() { return stop || generation != seenGeneration; });
+			if (stop) return;
+			seenGeneration = generation;
+
+			std::function<void(uint32_t)> currentTask = task;
+			lock.unlock();
+			currentTask(worker);
+			lock.lock();
+
+			if (--pending == 0) workDone.notify_all();
+		}
+	}
+
+
+
+
+	/// Queue Submit Batch
+	QueueSubmitBatch::QueueSubmitBatch(VkQueue queue) :
+		queue(queue_m)
+	{
+		queue_m = queue == VK_NULL_HANDLE ? impl::getRegistry<impl::Registry>().graphicsQueue.queue : queue;
+	}
+
+	void QueueSubmitBatch::add(VkCommandBuffer commandBuffer, const std::vector<VkSemaphore> & signalSemaphores)
+	{
+		add(commandBuffer, {}, {}, signalSemaphores);
+	}
+
+	void QueueSubmitBatch::add(VkCommandBuffer commandBuffer, const std::vector<VkSemaphore> & waitSemaphores, const std::vector<VkPipelineStageFlags> & waitStages, const std::vector<VkSemaphore> & signalSemaphores)
+	{
+		VKW_assert(waitSemaphores.size() == waitStages.size(), "Every wait semaphore needs a stage mask");
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// the command buffer may join the previous submit if it only has to wait for what came before
+		bool merge = !ranges.empty() && waitSemaphores.empty() && ranges.back().signalCount == 0;
+		if (!merge) {
+			ranges.push_back({
+				static_cast<uint32_t>(this->commandBuffers.size()), 0,
+				static_cast<uint32_t>(this->waitSemaphores.size()), static_cast<uint32_t>(waitSemaphores.size()),
+				static_cast<uint32_t>(this->signalSemaphores.size()), 0 });
+			this->waitSemaphores.insert(this->waitSemaphores.end(), waitSemaphores.begin(), waitSemaphores.end());
+			this->waitStages.insert(this->waitStages.end(), waitStages.begin(), waitStages.end());
+		}
+
+		Range & range = ranges.back();
+		commandBuffers.push_back(commandBuffer);
+		range.commandBufferCount++;
+
+		range.firstSignal = static_cast<uint32_t>(this->signalSemaphores.size()) - range.signalCount;
+		this->signalSemaphores.insert(this->signalSemaphores.end(), signalSemaphores.begin(), signalSemaphores.end());
+		range.signalCount += static_cast<uint32_t>(signalSemaphores.size());
+
+		statistics_m.commandBufferCount++;
+	}
+
+	bool QueueSubmitBatch::empty()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return ranges.empty();
+	}
+
+	void QueueSubmitBatch::flush(VkFence fence)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (ranges.empty() && fence == VK_NULL_HANDLE) return;
+
+		submitInfos.clear();
+		for (auto & x : ranges) {
+			VkSubmitInfo submitInfo = init::submitInfo();
+			submitInfo.commandBufferCount = x.commandBufferCount;
+			submitInfo.pCommandBuffers = commandBuffers.data() + x.firstCommandBuffer;
+			submitInfo.waitSemaphoreCount = x.waitCount;
+			submitInfo.pWaitSemaphores = waitSemaphores.data() + x.firstWait;
+			submitInfo.pWaitDstStageMask = waitStages.data() + x.firstWait;
+			submitInfo.signalSemaphoreCount = x.signalCount;
+			submitInfo.pSignalSemaphores = signalSemaphores.data() + x.firstSignal;
+			submitInfos.push_back(submitInfo);
+		}
+
+		Debug::errorCodeCheck(vkQueueSubmit(queue_m, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), fence), "Failed to flush QueueSubmitBatch");
+
+		statistics_m.submitInfoCount += submitInfos.size();
+		statistics_m.queueSubmitCount++;
+		statistics_m.submitsSaved = statistics_m.commandBufferCount > statistics_m.queueSubmitCount ? statistics_m.commandBufferCount - statistics_m.queueSubmitCount : 0;
+
+		ranges.clear();
+		commandBuffers.clear();
+		waitSemaphores.clear();
+		waitStages.clear();
+		signalSemaphores.clear();
+	}
+
+	QueueSubmitBatch::Statistics QueueSubmitBatch::statistics()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return statistics_m;
+	}
+
+	void QueueSubmitBatch::resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics_m = Statistics();
+	}
+
+
+
+
+	/// Transfer Ticket
+	TransferTicket::TransferTicket(CommandBuffer & commandBuffer, VkQueue queue, std::vector<VkSemaphore> signalSemaphores, FencePool * fencePool) :
+		fence(fencePool ? fencePool->acquire() : Fence(0)),
+		commandBuffer(commandBuffer),
+		fencePool(fencePool)
+	{
+		commandBuffer.endCommandBuffer();
+		commandBuffer.submitCommandBuffer(queue, signalSemaphores, fence);
+	}
+
+	TransferTicket::TransferTicket(TransferTicket && rhs) noexcept : TransferTicket()
+	{
+		*this = std::move(rhs);
+	}
+
+	TransferTicket::~TransferTicket()
+	{
+		wait(); // the Fence and CommandBuffer must not be destroyed while the transfer is pending
+	}
+
+	TransferTicket & TransferTicket::operator=(TransferTicket && rhs) noexcept
+	{
+		wait();
+		fence = std::move(rhs.fence);
+		commandBuffer = std::move(rhs.commandBuffer);
+		fencePool = std::exchange(rhs.fencePool, nullptr);
+
+		return *this;
+	}
+
+	bool TransferTicket::isDone() const
+	{
+		if (static_cast<VkFence>(fence) == VK_NULL_HANDLE) return true;
+		return fence.isSignaled();
+	}
+
+	bool TransferTicket::wait(uint64_t timeOut)
+	{
+		if (static_cast<VkFence>(fence) == VK_NULL_HANDLE) return true;
+
+		if (!fence.isSignaled() && !fence.wait(false, timeOut)) return false;
+		commandBuffer.freeCommandBuffer();
+
+		if (fencePool) fencePool->release(fence);
+		fence = Fence();
+		fencePool = nullptr;
+		return true;
+	}
+
+	bool TransferTicket::waitAll(std::vector<TransferTicket*> tickets, uint64_t timeOut)
+	{
+		std::vector<VkFence> fences;
+		fences.reserve(tickets.size());
+		for (auto x : tickets) if (static_cast<VkFence>(x->fence) != VK_NULL_HANDLE) fences.push_back(x->fence);
+
+		if (!Fence::waitAll(fences, timeOut)) return false;
+		for (auto x : tickets) x->wait();
+		return true;
+	}
+
+
+
+
+	/// Submit Builder
+	SubmitBuilder::SubmitBuilder() :
+		submitCount(submitCount_m)
+	{}
+
+	SubmitBuilder & SubmitBuilder::submit(VkQueue queue)
+	{
+		auto it = std::find_if(queues.begin(), queues.end(), [queue](const std::pair<VkQueue, std::vector<Submit>> & x) { return x.first == queue; });
+		if (it == queues.end()) {
+			queues.push_back({ queue, {} });
+			it = queues.end() - 1;
+		}
+
+		it->second.emplace_back();
+		current = &it->second.back();
+		submitCount_m++;
+		return *this;
+	}
+
+	SubmitBuilder & SubmitBuilder::commandBuffer(VkCommandBuffer commandBuffer)
+	{
+		VKW_assert(current != nullptr, "submit(queue) has to be called first");
+		current->commandBuffers.push_back(commandBuffer);
+		return *this;
+	}
+
+	SubmitBuilder & SubmitBuilder::wait(VkSemaphore semaphore, VkPipelineStageFlags stageMask, uint64_t value)
+	{
+		VKW_assert(current != nullptr, "submit(queue) has to be called first");
+		current->waitSemaphores.push_back(semaphore);
+		current->waitStages.push_back(stageMask);
+		current->waitValues.push_back(value);
+		current->timeline |= value != 0;
+		return *this;
+	}
+
+	SubmitBuilder & SubmitBuilder::signal(VkSemaphore semaphore, uint64_t value)
+	{
+		VKW_assert(current != nullptr, "submit(queue) has to be called first");
+		current->signalSemaphores.push_back(semaphore);
+		current->signalValues.push_back(value);
+		current->timeline |= value != 0;
+		return *this;
+	}
+
+	bool SubmitBuilder::empty() const
+	{
+		return submitCount_m == 0;
+	}
+
+	void SubmitBuilder::execute(VkFence fence)
+	{
+		for (size_t i = 0; i < queues.size(); i++) {
+			std::vector<Submit> & submits = queues[i].second;
+
+			std::vector<VkSubmitInfo> submitInfos;
+			std::vector<VkTimelineSemaphoreSubmitInfoKHR> timelineInfos;
+			submitInfos.reserve(submits.size());
+			timelineInfos.reserve(submits.size()); // no reallocation, submitInfos point into it
+
+			for (auto & x : submits) {
+				VkSubmitInfo submitInfo = init::submitInfo();
+				submitInfo.commandBufferCount = static_cast<uint32_t>(x.commandBuffers.size());
+				submitInfo.pCommandBuffers = x.commandBuffers.data();
+				submitInfo.waitSemaphoreCount = static_cast<uint32_t>(x.waitSemaphores.size());
+				submitInfo.pWaitSemaphores = x.waitSemaphores.data();
+				submitInfo.pWaitDstStageMask = x.waitStages.data();
+				submitInfo.signalSemaphoreCount = static_cast<uint32_t>(x.signalSemaphores.size());
+				submitInfo.pSignalSemaphores = x.signalSemaphores.data();
+
+				if (x.timeline) { // values of binary semaphores are ignored
+					VkTimelineSemaphoreSubmitInfoKHR timelineInfo = init::timelineSemaphoreSubmitInfo();
+					timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(x.waitValues.size());
+					timelineInfo.pWaitSemaphoreValues = x.waitValues.data();
+					timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(x.signalValues.size());
+					timelineInfo.pSignalSemaphoreValues = x.signalValues.data();
+					timelineInfos.push_back(timelineInfo);
+					submitInfo.pNext = &timelineInfos.back();
+				}
+
+				submitInfos.push_back(submitInfo);
+			}
+
+			VkFence queueFence = i + 1 == queues.size() ? fence : VK_NULL_HANDLE;
+			Debug::errorCodeCheck(vkQueueSubmit(queues[i].first, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), queueFence), "Failed to submit to Queue");
+		}
+
+		clear();
+	}
+
+	void SubmitBuilder::clear()
+	{
+		queues.clear();
+		current = nullptr;
+		submitCount_m = 0;
+	}
+
+
+
+
+	/// Barrier Builder
+	BarrierBuilder::BarrierBuilder() :
+		srcStageMask(srcStageMask_m),
+		dstStageMask(dstStageMask_m)
+	{}
+
+	void BarrierBuilder::transition(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask)
+	{
+		transition(image, newLayout, image.subresourceRange(aspectMask));
+	}
+
+	void BarrierBuilder::transition(Image & image, VkImageLayout newLayout, const VkImageSubresourceRange & range)
+	{
+		for (auto & x : image.layoutBarriers(newLayout, range)) {
+			srcStageMask_m |= tools::stageMaskOf(x.oldLayout);
+			imageBarriers.push_back(x);
+		}
+		dstStageMask_m |= tools::stageMaskOf(newLayout);
+	}
+
+	void BarrierBuilder::buffer(VkBuffer buffer, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask, VkDeviceSize offset, VkDeviceSize size)
+	{
+		VkBufferMemoryBarrier barrier = init::bufferMemoryBarrier();
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		bufferBarriers.push_back(barrier);
+
+		srcStageMask_m |= srcStageMask;
+		dstStageMask_m |= dstStageMask;
+	}
+
+	void BarrierBuilder::buffer(const SubBuffer & buffer, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask)
+	{
+		this->buffer(static_cast<VkBuffer>(buffer), srcAccessMask, srcStageMask, dstAccessMask, dstStageMask, buffer.offset, buffer.size);
+	}
+
+	void BarrierBuilder::releaseBuffer(VkBuffer buffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (srcQueueFamily == dstQueueFamily) return;
+
+		VkBufferMemoryBarrier barrier = init::bufferMemoryBarrier();
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = 0; // ignored on release
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		bufferBarriers.push_back(barrier);
+
+		srcStageMask_m |= srcStageMask;
+	}
+
+	void BarrierBuilder::acquireBuffer(VkBuffer buffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (srcQueueFamily == dstQueueFamily) return;
+
+		VkBufferMemoryBarrier barrier = init::bufferMemoryBarrier();
+		barrier.srcAccessMask = 0; // ignored on acquire
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		bufferBarriers.push_back(barrier);
+
+		dstStageMask_m |= dstStageMask;
+	}
+
+	bool BarrierBuilder::empty() const
+	{
+		return imageBarriers.empty() && bufferBarriers.empty();
+	}
+
+	void BarrierBuilder::record(VkCommandBuffer commandBuffer, VkDependencyFlags dependencyFlags)
+	{
+		if (empty()) return;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStageMask == 0 ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : srcStageMask,
+			dstStageMask == 0 ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : dstStageMask,
+			dependencyFlags,
+			0, nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+		);
+
+		clear();
+	}
+
+	void BarrierBuilder::image(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange & range, VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStageMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStageMask)
+	{
+		VkImageMemoryBarrier barrier = init::imageMemoryBarrier();
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = range;
+		imageBarriers.push_back(barrier);
+
+		srcStageMask_m |= srcStageMask;
+		dstStageMask_m |= dstStageMask;
+	}
+
+	bool BarrierBuilder::contains(VkImage image) const
+	{
+		for (auto & x : imageBarriers) if (x.image == image) return true;
+		return false;
+	}
+
+	void BarrierBuilder::splitOwnershipTransfer(uint32_t srcQueueFamily, uint32_t dstQueueFamily, BarrierBuilder & acquire)
+	{
+		if (srcQueueFamily == dstQueueFamily) return;
+
+		for (auto & x : imageBarriers) {
+			x.srcQueueFamilyIndex = srcQueueFamily;
+			x.dstQueueFamilyIndex = dstQueueFamily;
+
+			acquire.imageBarriers.push_back(x);
+			acquire.imageBarriers.back().srcAccessMask = 0; // ignored on acquire
+			x.dstAccessMask = 0; // ignored on release
+		}
+
+		for (auto & x : bufferBarriers) {
+			x.srcQueueFamilyIndex = srcQueueFamily;
+			x.dstQueueFamilyIndex = dstQueueFamily;
+
+			acquire.bufferBarriers.push_back(x);
+			acquire.bufferBarriers.back().srcAccessMask = 0;
+			x.dstAccessMask = 0;
+		}
+
+		acquire.dstStageMask_m |= dstStageMask_m;
+		dstStageMask_m = 0; // recorded as BOTTOM_OF_PIPE, the release does not wait for anything on srcQueueFamily
+	}
+
+	void BarrierBuilder::clear()
+	{
+		imageBarriers.clear();
+		bufferBarriers.clear();
+		srcStageMask_m = 0;
+		dstStageMask_m = 0;
+	}
+
+
+
+
+	/// Transfer Batch
+	TransferBatch::TransferBatch(VkCommandPool commandPool, VkQueue queue, uint32_t queueFamily, uint32_t dstQueueFamily) :
+		copyCount(copyCount_m),
+		registry(impl::getRegistry<impl::Registry>())
+	{
+		this->commandPool = commandPool == VK_NULL_HANDLE ? registry.transferCommandPool : commandPool;
+		this->queue = queue == VK_NULL_HANDLE ? registry.transferQueue.queue : queue;
+
+		// a family of -1 means the registry has no such queue, it ends up as VK_QUEUE_FAMILY_IGNORED
+		if (queueFamily == VK_QUEUE_FAMILY_IGNORED && queue == VK_NULL_HANDLE) queueFamily = static_cast<uint32_t>(registry.transferQueue.family);
+		if (dstQueueFamily == VK_QUEUE_FAMILY_IGNORED) dstQueueFamily = static_cast<uint32_t>(registry.graphicsQueue.family);
+		this->queueFamily = queueFamily;
+		this->dstQueueFamily = dstQueueFamily;
+	}
+
+	TransferBatch::TransferBatch(const CreateInfo & createInfo) :
+		TransferBatch(createInfo.commandPool, createInfo.queue, createInfo.queueFamily, createInfo.dstQueueFamily)
+	{}
+
+	void TransferBatch::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy & region)
+	{
+		bufferCopies[{ srcBuffer, dstBuffer }].push_back(region);
+		copyCount_m++;
+	}
+
+	void TransferBatch::copyBuffer(const SubBuffer & srcBuffer, const SubBuffer & dstBuffer, VkDeviceSize size)
+	{
+		copyBuffer(srcBuffer, dstBuffer, VkBufferCopy{ srcBuffer.offset, dstBuffer.offset, size == VK_WHOLE_SIZE ? dstBuffer.size : size });
+	}
+
+	void TransferBatch::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy> & regions, VkImageLayout dstLayout)
+	{
+		auto it = imageCopies.find({ srcBuffer, dstImage });
+		if (it == imageCopies.end()) it = imageCopies.insert({ { srcBuffer, dstImage }, { dstLayout, {} } }).first;
+		VKW_assert(it->second.layout == dstLayout, "All copies into an image in one TransferBatch have to use the same layout");
+
+		it->second.regions.insert(it->second.regions.end(), regions.begin(), regions.end());
+		copyCount_m += static_cast<uint32_t>(regions.size());
+	}
+
+	void TransferBatch::transitionBeforeCopies(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask)
+	{
+		barriersBefore.transition(image, newLayout, aspectMask);
+	}
+
+	void TransferBatch::transitionAfterCopies(Image & image, VkImageLayout newLayout, VkImageAspectFlags aspectMask)
+	{
+		barriersAfter.transition(image, newLayout, aspectMask);
+	}
+
+	bool TransferBatch::empty() const
+	{
+		return copyCount == 0 && barriersBefore.empty() && barriersAfter.empty();
+	}
+
+	void TransferBatch::record(VkCommandBuffer commandBuffer)
+	{
+		barriersBefore.record(commandBuffer);
+
+		for (auto & x : bufferCopies) {
+			mergeRegions(x.second);
+			vkCmdCopyBuffer(commandBuffer, x.first.first, x.first.second, static_cast<uint32_t>(x.second.size()), x.second.data());
+		}
+
+		for (auto & x : imageCopies) {
+			vkCmdCopyBufferToImage(commandBuffer, x.first.first, x.first.second, x.second.layout, static_cast<uint32_t>(x.second.regions.size()), x.second.regions.data());
+		}
+
+		if (transfersOwnership()) releaseOwnership();
+		barriersAfter.record(commandBuffer);
+
+		clear();
+	}
+
+	TransferTicket TransferBatch::submit(std::vector<VkSemaphore> signalSemaphores)
+	{
+		if (empty()) return TransferTicket();
+
+		CommandBuffer commandBuffer(commandPool);
+		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		record(commandBuffer);
+
+		return TransferTicket(commandBuffer, queue, signalSemaphores, &fencePool);
+	}
+
+	void TransferBatch::clear()
+	{
+		bufferCopies.clear();
+		imageCopies.clear();
+		barriersBefore.clear();
+		barriersAfter.clear();
+		copyCount_m = 0;
+	}
+
+	bool TransferBatch::transfersOwnership() const
+	{
+		return queueFamily != VK_QUEUE_FAMILY_IGNORED && dstQueueFamily != VK_QUEUE_FAMILY_IGNORED && queueFamily != dstQueueFamily;
+	}
+
+	bool TransferBatch::needsAcquire() const
+	{
+		return !acquireBarriers.empty();
+	}
+
+	void TransferBatch::recordAcquire(VkCommandBuffer commandBuffer)
+	{
+		acquireBarriers.record(commandBuffer);
+	}
+
+	TransferTicket TransferBatch::submitAcquire(VkCommandPool commandPool, VkQueue queue)
+	{
+		if (!needsAcquire()) return TransferTicket();
+
+		CommandBuffer commandBuffer(commandPool == VK_NULL_HANDLE ? registry.graphicsCommandPool : commandPool);
+		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		recordAcquire(commandBuffer);
+
+		return TransferTicket(commandBuffer, queue == VK_NULL_HANDLE ? registry.graphicsQueue.queue : queue, {}, &fencePool);
+	}
+
+	void TransferBatch::releaseOwnership()
+	{
+		// the consumer is unknown, so the acquire makes the writes visible to every read on dstQueueFamily
+		for (auto & x : bufferCopies) {
+			VkDeviceSize begin = std::numeric_limits<VkDeviceSize>::max();
+			VkDeviceSize end = 0;
+			for (auto & region : x.second) {
+				begin = std::min(begin, region.dstOffset);
+				end = std::max(end, region.dstOffset + region.size);
+			}
+			barriersAfter.buffer(x.first.second, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, begin, end - begin);
+		}
+
+		// images with a transition after the copies are released by that transition
+		for (auto & x : imageCopies) {
+			if (barriersAfter.contains(x.first.second)) continue;
+
+			for (auto & region : x.second.regions) {
+				VkImageSubresourceRange range = {};
+				range.aspectMask = region.imageSubresource.aspectMask;
+				range.baseMipLevel = region.imageSubresource.mipLevel;
+				range.levelCount = 1;
+				range.baseArrayLayer = region.imageSubresource.baseArrayLayer;
+				range.layerCount = region.imageSubresource.layerCount;
+				barriersAfter.image(x.first.second, x.second.layout, x.second.layout, range, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			}
+		}
+
+		barriersAfter.splitOwnershipTransfer(queueFamily, dstQueueFamily, acquireBarriers);
+	}
+
+	void TransferBatch::mergeRegions(std::vector<VkBufferCopy> & regions)
+	{
+		std::sort(regions.begin(), regions.end(), [](const VkBufferCopy & a, const VkBufferCopy & b) { return a.srcOffset < b.srcOffset; });
+
+		size_t last = 0;
+		for (size_t i = 1; i < regions.size(); i++) {
+			VkBufferCopy & previous = regions[last];
+			if (previous.srcOffset + previous.size == regions[i].srcOffset && previous.dstOffset + previous.size == regions[i].dstOffset)
+				previous.size += regions[i].size;
+			else regions[++last] = regions[i];
+		}
+		if (!regions.empty()) regions.resize(last + 1);
+	}
+
+
+
+
+	/// Staging Belt
+	StagingBelt::StagingBelt(VkDeviceSize size, VkCommandPool commandPool, VkQueue queue, uint32_t queueFamily, uint32_t dstQueueFamily) :
+		size(size_m),
+		buffer(buffer_m),
+		registry(impl::getRegistry<impl::Registry>()),
+		size_m(size),
+		memory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
+		batch(commandPool, queue, queueFamily, dstQueueFamily)
+	{
+		buffer_m.createBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, size);
+
+		Memory::AllocInfo allocInfo;
+		allocInfo.memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		allocInfo.buffers = { buffer_m };
+		allocInfo.persistentlyMapped = true;
+		memory.allocateMemory(allocInfo);
+	}
+
+	StagingBelt::StagingBelt(const CreateInfo & createInfo) :
+		StagingBelt(createInfo.size, createInfo.commandPool, createInfo.queue, createInfo.queueFamily, createInfo.dstQueueFamily)
+	{}
+
+	StagingBelt::~StagingBelt()
+	{
+		submit();
+		wait();
+	}
+
+	void StagingBelt::upload(VkBuffer dstBuffer, const void * data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		VkDeviceSize offset = reserve(size, bufferUploadAlignment);
+		buffer_m.write(data, static_cast<size_t>(size), offset);
+
+		batch.copyBuffer(buffer_m, dstBuffer, VkBufferCopy{ offset, dstOffset, size });
+	}
+
+	void StagingBelt::upload(const SubBuffer & dstBuffer, const void * data, VkDeviceSize size)
+	{
+		VKW_assert(size <= dstBuffer.size, "Upload is bigger than the SubBuffer");
+		upload(static_cast<VkBuffer>(dstBuffer), data, size, dstBuffer.offset);
+	}
+
+	void StagingBelt::upload(VkImage dstImage, const void * data, VkDeviceSize size, std::vector<VkBufferImageCopy> regions, VkImageLayout dstLayout)
+	{
+		VKW_assert(!regions.empty(), "No copy regions for image upload");
+
+		// bufferOffset has to be a multiple of the texel block size, 16 covers every format
+		VkDeviceSize alignment = std::max<VkDeviceSize>(16, registry.physicalDevice.properties.limits.optimalBufferCopyOffsetAlignment);
+		VkDeviceSize offset = reserve(size, alignment);
+		buffer_m.write(data, static_cast<size_t>(size), offset);
+
+		for (auto & x : regions) x.bufferOffset += offset;
+		batch.copyBufferToImage(buffer_m, dstImage, regions, dstLayout);
+	}
+
+	void StagingBelt::submit(std::vector<VkSemaphore> signalSemaphores)
+	{
+		if (batch.empty()) return;
+
+		memory.flushDirtyRanges();
+
+		inFlight.emplace_back();
+		inFlight.back().ticket = batch.submit(signalSemaphores);
+		inFlight.back().end = head;
+	}
+
+	void StagingBelt::wait()
+	{
+		std::vector<TransferTicket*> tickets;
+		for (auto & x : inFlight) tickets.push_back(&x.ticket);
+
+		TransferTicket::waitAll(tickets);
+		recycle();
+	}
+
+	bool StagingBelt::needsAcquire() const
+	{
+		return batch.needsAcquire();
+	}
+
+	void StagingBelt::recordAcquire(VkCommandBuffer commandBuffer)
+	{
+		batch.recordAcquire(commandBuffer);
+	}
+
+	TransferTicket StagingBelt::submitAcquire(VkCommandPool commandPool, VkQueue queue)
+	{
+		return batch.submitAcquire(commandPool, queue);
+	}
+
+	VkDeviceSize StagingBelt::reserve(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		VKW_assert(size + alignment <= size_m, "Upload is bigger than the StagingBelt");
+
+		recycle();
+
+		VkDeviceSize offset;
+		while (!tryReserve(size, alignment, offset)) { // belt is full, wait for the oldest upload
+			submit();
+			inFlight.front().ticket.wait();
+			recycle();
+		}
+
+		return offset;
+	}
+
+	bool StagingBelt::tryReserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize & offset)
+	{
+		// used space goes from tail to head, head only equals tail if the belt is empty
+		offset = tools::alignUp(head, alignment);
+
+		if (head >= tail) {
+			if (offset + size > size_m) {
+				if (size >= tail) return false;
+				offset = 0; // wrap around
+			}
+		}
+		else if (offset + size >= tail) return false;
+
+		head = offset + size;
+		return true;
+	}
+
+	void StagingBelt::recycle()
+	{
+		while (!inFlight.empty() && inFlight.front().ticket.isDone()) {
+			inFlight.front().ticket.wait(); // hands the Fence back to the pool
+			tail = inFlight.front().end;
+			inFlight.pop_front();
+		}
+
+		if (inFlight.empty() && batch.empty()) {
+			head = 0;
+			tail = 0;
+		}
+	}
+}
@@ -63,6 +63,16 @@ namespace vkw {
 		createDescriptorPool(poolSizes, maxSets, flags);
 	}
 
+	DescriptorPool::DescriptorPool(const DescriptorPool & rhs) : DescriptorPool()
+	{
+		*this = rhs;
+	}
+
+	DescriptorPool::DescriptorPool(DescriptorPool && rhs) noexcept : DescriptorPool()
+	{
+		*this = std::move(rhs);
+	}
+
 	void DescriptorPool::createDescriptorPool(const CreateInfo2 & createInfo)
 	{
 		CreateInfo info = {};
@@ -99,7 +109,7 @@ namespace vkw {
 		info.pPoolSizes = createInfo.poolSizes.data();
 		info.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateDescriptorPool(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Descriptor Pool");
+		vkw::Debug::errorCodeCheck(vkCreateDescriptorPool(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Descriptor Pool");
 	}
 
 	void DescriptorPool::createDescriptorPool(const std::vector<VkDescriptorPoolSize> & poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags)
@@ -126,6 +136,16 @@ namespace vkw {
 		return *this;
 	}
 
+	DescriptorPool & DescriptorPool::operator=(DescriptorPool && rhs) noexcept
+	{
+		impl::Object<impl::VkwDescriptorPool>::operator=(std::move(rhs));
+		poolSizes_m = std::move(rhs.poolSizes_m);
+		maxSets_m = rhs.maxSets_m;
+		flags_m = rhs.flags_m;
+
+		return *this;
+	}
+
 
 
 
@@ -145,6 +165,16 @@ namespace vkw {
 		createDescriptorSetLayout(bindings, flags);
 	}
 
+	DescriptorSetLayout::DescriptorSetLayout(const DescriptorSetLayout & rhs) : DescriptorSetLayout()
+	{
+		*this = rhs;
+	}
+
+	DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout && rhs) noexcept : DescriptorSetLayout()
+	{
+		*this = std::move(rhs);
+	}
+
 	void DescriptorSetLayout::createDescriptorSetLayout(const CreateInfo & createInfo)
 	{
 		for (auto x : createInfo.layoutBindings) {
@@ -156,7 +186,7 @@ namespace vkw {
 		layoutInfo.pBindings = createInfo.layoutBindings.data();
 		layoutInfo.flags = createInfo.flags;
 		layoutInfo.pNext = createInfo.pNext;
-		vkw::Debug::errorCodeCheck(vkCreateDescriptorSetLayout(registry.device, &layoutInfo, nullptr, pVkObject.createNew()), "Failed to create DescriptorSetLayout");
+		vkw::Debug::errorCodeCheck(vkCreateDescriptorSetLayout(registry.device, &layoutInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create DescriptorSetLayout");
 	}
 
 	void DescriptorSetLayout::createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> & bindings, VkDescriptorSetLayoutCreateFlags flags)
@@ -176,6 +206,15 @@ namespace vkw {
 		return *this;
 	}
 
+	DescriptorSetLayout & DescriptorSetLayout::operator=(DescriptorSetLayout && rhs) noexcept
+	{
+		impl::Object<impl::VkwDescriptorSetLayout>::operator=(std::move(rhs));
+		layoutBindings_m = std::move(rhs.layoutBindings_m);
+		flags = rhs.flags;
+
+		return *this;
+	}
+
 
 
 
@@ -194,6 +233,16 @@ namespace vkw {
 		allocateDescriptorSet(descriptorPool, layout);
 	}
 
+	DescriptorSet::DescriptorSet(const DescriptorSet & rhs) : DescriptorSet()
+	{
+		*this = rhs;
+	}
+
+	DescriptorSet::DescriptorSet(DescriptorSet && rhs) noexcept : DescriptorSet()
+	{
+		*this = std::move(rhs);
+	}
+
 	void DescriptorSet::allocateDescriptorSet(const AllocInfo & createInfo)
 	{
 		layout_m = createInfo.layout;
@@ -225,119 +274,849 @@ namespace vkw {
 		return *this;
 	}
 
+	DescriptorSet & DescriptorSet::operator=(DescriptorSet && rhs) noexcept
+	{
+		impl::Object <impl::VkwDescriptorSet>::operator=(std::move(rhs));
+		descriptorPool = rhs.descriptorPool;
+		layout_m = rhs.layout_m;
+
+		return *this;
+	}
+
 	void DescriptorSet::update(const std::vector<WriteInfo> & writeInfos, const std::vector<CopyInfo> & copyInfos)
 	{
 		std::vector<VkWriteDescriptorSet> writes;
-		
-		for (auto x : writeInfos) {
+		std::vector<VkCopyDescriptorSet> copies;
+		writes.reserve(writeInfos.size());
+		copies.reserve(copyInfos.size());
+
+		recordUpdate(*this, writeInfos, copyInfos, writes, copies);
+
+		vkUpdateDescriptorSets(registry.device, static_cast<uint32_t>(writes.size()), writes.data(), static_cast<uint32_t>(copies.size()), copies.data());
+	}
+
+	void DescriptorSet::update(const DescriptorUpdateTemplate & updateTemplate, const void * pData)
+	{
+		VKW_assert(static_cast<VkDescriptorSetLayout>(*updateTemplate.layout) == static_cast<VkDescriptorSetLayout>(*layout_m), "DescriptorUpdateTemplate was created for a different DescriptorSetLayout");
+		updateTemplate.update(*pVkObject, pData);
+	}
+
+	void DescriptorSet::recordUpdate(const DescriptorSet & set, const std::vector<WriteInfo> & writeInfos, const std::vector<CopyInfo> & copyInfos, std::vector<VkWriteDescriptorSet> & writes, std::vector<VkCopyDescriptorSet> & copies)
+	{
+		for (auto & x : writeInfos) {
 			VkWriteDescriptorSet write = vkw::init::writeDescriptorSet();
-			write.dstSet = *pVkObject;
+			write.dstSet = set;
 			write.dstBinding = x.dstBinding;
 			write.dstArrayElement = x.dstArrayElement;
 			write.descriptorCount = x.descriptorCount;
-			write.descriptorType = layout->layoutBindings.at(x.dstBinding).descriptorType;
+			write.descriptorType = set.layout->layoutBindings.at(x.dstBinding).descriptorType;
 			write.pImageInfo = x.pImageInfo;
 			write.pBufferInfo = x.pBufferInfo;
 			write.pTexelBufferView = x.pTexelBufferView;
 			writes.push_back(write);
 		}
 
-		std::vector<VkCopyDescriptorSet> copys;
-
-		for (auto x : copyInfos) {
+		for (auto & x : copyInfos) {
 			VkCopyDescriptorSet copy = init::copyDescriptorSet();
-			copy.descriptorCount = x.descriptorCount;
-			copy.dstArrayElement = x.dstArrayElement;
+			copy.srcSet = x.srcSet;
+			copy.srcBinding = x.srcBinding;
+			copy.srcArrayElement = x.srcArrayElement;
+			copy.dstSet = set;
 			copy.dstBinding = x.dstBinding;
+			copy.dstArrayElement = x.dstArrayElement;
+			copy.descriptorCount = x.descriptorCount;
+			copies.push_back(copy);
+		}
+	}
+
+	void DescriptorSet::allocateDescriptorSets(std::vector<DescriptorSet> & descriptorSets, VkDescriptorPool descriptorPool, const DescriptorSetLayout & layout)
+	{
+		std::vector<std::reference_wrapper<DescriptorSet>> sets(descriptorSets.begin(), descriptorSets.end());
+		std::vector<std::reference_wrapper<const DescriptorSetLayout>> layouts(descriptorSets.size(), std::cref(layout));
+		allocateDescriptorSets(sets, descriptorPool, layouts);
+	}
+
+	void DescriptorSet::allocateDescriptorSets(std::vector<std::reference_wrapper<DescriptorSet>> descriptorSets, VkDescriptorPool descriptorPool, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts)
+	{
+		Debug::errorCodeCheck(tryAllocateDescriptorSets(descriptorSets, descriptorPool, layouts), "Failed to allocate Descriptor Sets");
+	}
 
-			copys.push_back(copy);
+	VkResult DescriptorSet::tryAllocateDescriptorSets(std::vector<std::reference_wrapper<DescriptorSet>> & descriptorSets, VkDescriptorPool descriptorPool, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts)
+	{
+		VKW_assert(descriptorSets.size() == layouts.size(), "every DescriptorSet needs a layout");
+		if (descriptorSets.empty()) return VK_SUCCESS;
+
+		std::vector<VkDescriptorSetLayout> vkLayouts(layouts.size());
+		for (size_t i = 0; i < layouts.size(); i++) vkLayouts[i] = layouts[i].get();
+
+		std::vector<VkDescriptorSet> vkDescriptorSets(descriptorSets.size());
+
+		VkDescriptorSetAllocateInfo allocInfo = init::descriptorSetAllocateInfo();
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(vkLayouts.size());
+		allocInfo.pSetLayouts = vkLayouts.data();
+
+		VkResult result = vkAllocateDescriptorSets(descriptorSets[0].get().registry.device, &allocInfo, vkDescriptorSets.data());
+		if (result != VK_SUCCESS) return result;
+
+		for (size_t i = 0; i < descriptorSets.size(); i++) {
+			DescriptorSet & set = descriptorSets[i];
+			set.descriptorPool = descriptorPool;
+			set.layout_m = &layouts[i].get();
+			*set.pVkObject.createNew() = vkDescriptorSets[i];
 		}
 
-		vkUpdateDescriptorSets(registry.device, static_cast<uint32_t>(writes.size()), writes.data(), static_cast<uint32_t>(copys.size()), copys.data());
+		return VK_SUCCESS;
 	}
 
+	void DescriptorSet::updateDescriptorSets(const std::vector<UpdateInfo> & updateInfos)
+	{
+		if (updateInfos.empty()) return;
 
+		size_t writeCount = 0;
+		size_t copyCount = 0;
+		for (auto & x : updateInfos) {
+			writeCount += x.writeInfos.size();
+			copyCount += x.copyInfos.size();
+		}
 
+		std::vector<VkWriteDescriptorSet> writes;
+		std::vector<VkCopyDescriptorSet> copies;
+		writes.reserve(writeCount);
+		copies.reserve(copyCount);
 
+		for (auto & x : updateInfos) recordUpdate(x.descriptor.get(), x.writeInfos, x.copyInfos, writes, copies);
 
-	/// Memory Ranges
-	bool MemoryRanges::query(VkDeviceSize size) const
+		vkUpdateDescriptorSets(updateInfos[0].descriptor.get().registry.device, static_cast<uint32_t>(writes.size()), writes.data(), static_cast<uint32_t>(copies.size()), copies.data());
+	}
+
+
+
+
+
+	/// Descriptor Update Template
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate() :
+		layout(layout_m),
+		entries(entries_m),
+		dataSize(dataSize_m)
+	{}
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(const CreateInfo & createInfo) : DescriptorUpdateTemplate()
+	{
+		createDescriptorUpdateTemplate(createInfo);
+	}
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(const DescriptorSetLayout & layout, const std::vector<Entry> & entries) : DescriptorUpdateTemplate()
+	{
+		createDescriptorUpdateTemplate(layout, entries);
+	}
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(const DescriptorUpdateTemplate & rhs) : DescriptorUpdateTemplate()
+	{
+		*this = rhs;
+	}
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(DescriptorUpdateTemplate && rhs) noexcept : DescriptorUpdateTemplate()
+	{
+		*this = std::move(rhs);
+	}
+
+	void DescriptorUpdateTemplate::createDescriptorUpdateTemplate(const CreateInfo & createInfo)
 	{
-		for (auto & x : freeRanges) {
-			if (x.second >= size) return true;
+		const DescriptorSetLayout & setLayout = createInfo.layout;
+		layout_m = &setLayout;
+		entries_m = createInfo.entries;
+
+		if (entries_m.empty()) {
+			size_t offset = 0;
+			for (auto & x : setLayout.layoutBindings) {
+				if (x.second.descriptorCount == 0) continue;
+
+				Entry entry = {};
+				entry.binding = x.first;
+				entry.offset = offset;
+				entry.stride = descriptorSize(x.second.descriptorType);
+				entry.descriptorCount = x.second.descriptorCount;
+				entries_m.push_back(entry);
+
+				offset += (entry.stride * entry.descriptorCount + 7) & ~size_t(7); // inline uniform blocks are counted in bytes
+			}
+		}
+
+		std::vector<VkDescriptorUpdateTemplateEntry> vkEntries;
+		vkEntries.reserve(entries_m.size());
+		dataSize_m = 0;
+
+		for (auto & x : entries_m) {
+			const VkDescriptorSetLayoutBinding & binding = setLayout.layoutBindings.at(x.binding);
+			VKW_assert(x.dstArrayElement < binding.descriptorCount, "Entry starts past the end of its binding");
+			if (x.descriptorCount == 0) x.descriptorCount = binding.descriptorCount - x.dstArrayElement;
+
+			VkDescriptorUpdateTemplateEntry entry = {};
+			entry.dstBinding = x.binding;
+			entry.dstArrayElement = x.dstArrayElement;
+			entry.descriptorCount = x.descriptorCount;
+			entry.descriptorType = binding.descriptorType;
+			entry.offset = x.offset;
+			entry.stride = x.stride;
+			vkEntries.push_back(entry);
+
+			dataSize_m = std::max(dataSize_m, x.offset + x.stride * (x.descriptorCount - 1) + descriptorSize(binding.descriptorType));
+		}
+
+		VkDescriptorUpdateTemplateCreateInfo templateInfo = init::descriptorUpdateTemplateCreateInfo();
+		templateInfo.pNext = createInfo.pNext;
+		templateInfo.flags = createInfo.flags;
+		templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(vkEntries.size());
+		templateInfo.pDescriptorUpdateEntries = vkEntries.data();
+		templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		templateInfo.descriptorSetLayout = setLayout;
+
+		auto func = registry.descriptorUpdateTemplateFunctions.createDescriptorUpdateTemplate;
+		VKW_assert(func != nullptr, "VK_KHR_descriptor_update_template is not enabled");
+
+		Debug::errorCodeCheck(func(registry.device, &templateInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create DescriptorUpdateTemplate");
+	}
+
+	void DescriptorUpdateTemplate::createDescriptorUpdateTemplate(const DescriptorSetLayout & layout, const std::vector<Entry> & entries)
+	{
+		CreateInfo createInfo = {};
+		createInfo.layout = (DescriptorSetLayout*)&layout;
+		createInfo.entries = entries;
+		createDescriptorUpdateTemplate(createInfo);
+	}
+
+	DescriptorUpdateTemplate & DescriptorUpdateTemplate::operator=(const DescriptorUpdateTemplate & rhs)
+	{
+		impl::Object<impl::VkwDescriptorUpdateTemplate>::operator=(rhs);
+		layout_m = rhs.layout_m;
+		entries_m = rhs.entries_m;
+		dataSize_m = rhs.dataSize_m;
+
+		return *this;
+	}
+
+	DescriptorUpdateTemplate & DescriptorUpdateTemplate::operator=(DescriptorUpdateTemplate && rhs) noexcept
+	{
+		impl::Object<impl::VkwDescriptorUpdateTemplate>::operator=(std::move(rhs));
+		layout_m = rhs.layout_m;
+		entries_m = std::move(rhs.entries_m);
+		dataSize_m = rhs.dataSize_m;
+
+		return *this;
+	}
+
+	size_t DescriptorUpdateTemplate::offset(uint32_t binding, uint32_t arrayElement) const
+	{
+		for (auto & x : entries_m) {
+			if (x.binding == binding && arrayElement >= x.dstArrayElement && arrayElement < x.dstArrayElement + x.descriptorCount) {
+				return x.offset + x.stride * (arrayElement - x.dstArrayElement);
+			}
+		}
+
+		VKW_assert(false, "binding is not part of the DescriptorUpdateTemplate");
+		return 0;
+	}
+
+	void DescriptorUpdateTemplate::update(VkDescriptorSet descriptorSet, const void * pData) const
+	{
+		registry.descriptorUpdateTemplateFunctions.updateDescriptorSetWithTemplate(registry.device, descriptorSet, *pVkObject, pData);
+	}
+
+	size_t DescriptorUpdateTemplate::descriptorSize(VkDescriptorType type)
+	{
+		switch (type) {
+		case VK_DESCRIPTOR_TYPE_SAMPLER:
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			return sizeof(VkDescriptorImageInfo);
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+			return sizeof(VkDescriptorBufferInfo);
+		case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+		case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+			return sizeof(VkBufferView);
+		case VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT:
+			return 1;
+		default:
+			VKW_assert(false, "descriptor type is not supported by DescriptorUpdateTemplate");
+			return 0;
 		}
-		return false;
+	}
+
+
+
+
+
+	/// Descriptor Update Batch
+	void DescriptorUpdateBatch::addWrite(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, uint32_t arrayElement, uint32_t descriptorCount, InfoStore store, uint32_t first)
+	{
+		VkWriteDescriptorSet write = init::writeDescriptorSet();
+		write.dstSet = set;
+		write.dstBinding = binding;
+		write.dstArrayElement = arrayElement;
+		write.descriptorCount = descriptorCount;
+		write.descriptorType = type;
+
+		writes.push_back(write);
+		infoRefs.push_back({ store, first });
+	}
+
+	void DescriptorUpdateBatch::write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo & bufferInfo, uint32_t arrayElement)
+	{
+		addWrite(set, binding, type, arrayElement, 1, BUFFER_INFOS, static_cast<uint32_t>(bufferInfos.size()));
+		bufferInfos.push_back(bufferInfo);
+	}
+
+	void DescriptorUpdateBatch::write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo & imageInfo, uint32_t arrayElement)
+	{
+		addWrite(set, binding, type, arrayElement, 1, IMAGE_INFOS, static_cast<uint32_t>(imageInfos.size()));
+		imageInfos.push_back(imageInfo);
+	}
+
+	void DescriptorUpdateBatch::write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, VkBufferView texelBufferView, uint32_t arrayElement)
+	{
+		addWrite(set, binding, type, arrayElement, 1, TEXEL_BUFFER_VIEWS, static_cast<uint32_t>(texelBufferViews.size()));
+		texelBufferViews.push_back(texelBufferView);
+	}
+
+	void DescriptorUpdateBatch::write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const std::vector<VkDescriptorBufferInfo> & bufferInfos, uint32_t arrayElement)
+	{
+		if (bufferInfos.empty()) return;
+		addWrite(set, binding, type, arrayElement, static_cast<uint32_t>(bufferInfos.size()), BUFFER_INFOS, static_cast<uint32_t>(this->bufferInfos.size()));
+		this->bufferInfos.insert(this->bufferInfos.end(), bufferInfos.begin(), bufferInfos.end());
+	}
+
+	void DescriptorUpdateBatch::write(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, const std::vector<VkDescriptorImageInfo> & imageInfos, uint32_t arrayElement)
+	{
+		if (imageInfos.empty()) return;
+		addWrite(set, binding, type, arrayElement, static_cast<uint32_t>(imageInfos.size()), IMAGE_INFOS, static_cast<uint32_t>(this->imageInfos.size()));
+		this->imageInfos.insert(this->imageInfos.end(), imageInfos.begin(), imageInfos.end());
+	}
+
+	void DescriptorUpdateBatch::write(const DescriptorSet & set, uint32_t binding, const VkDescriptorBufferInfo & bufferInfo, uint32_t arrayElement)
+	{
+		write(static_cast<VkDescriptorSet>(set), binding, set.layout->layoutBindings.at(binding).descriptorType, bufferInfo, arrayElement);
+	}
+
+	void DescriptorUpdateBatch::write(const DescriptorSet & set, uint32_t binding, const VkDescriptorImageInfo & imageInfo, uint32_t arrayElement)
+	{
+		write(static_cast<VkDescriptorSet>(set), binding, set.layout->layoutBindings.at(binding).descriptorType, imageInfo, arrayElement);
+	}
+
+	void DescriptorUpdateBatch::copy(VkDescriptorSet srcSet, uint32_t srcBinding, VkDescriptorSet dstSet, uint32_t dstBinding, uint32_t descriptorCount, uint32_t srcArrayElement, uint32_t dstArrayElement)
+	{
+		VkCopyDescriptorSet copy = init::copyDescriptorSet();
+		copy.srcSet = srcSet;
+		copy.srcBinding = srcBinding;
+		copy.srcArrayElement = srcArrayElement;
+		copy.dstSet = dstSet;
+		copy.dstBinding = dstBinding;
+		copy.dstArrayElement = dstArrayElement;
+		copy.descriptorCount = descriptorCount;
+		copies.push_back(copy);
+	}
+
+	bool DescriptorUpdateBatch::empty() const
+	{
+		return writes.empty() && copies.empty();
+	}
+
+	void DescriptorUpdateBatch::flush()
+	{
+		if (empty()) return;
+
+		for (size_t i = 0; i < writes.size(); i++) {
+			switch (infoRefs[i].store) {
+			case BUFFER_INFOS: writes[i].pBufferInfo = &bufferInfos[infoRefs[i].first]; break;
+			case IMAGE_INFOS: writes[i].pImageInfo = &imageInfos[infoRefs[i].first]; break;
+			case TEXEL_BUFFER_VIEWS: writes[i].pTexelBufferView = &texelBufferViews[infoRefs[i].first]; break;
+			}
+		}
+
+		vkUpdateDescriptorSets(impl::getRegistry<impl::Registry>().device, static_cast<uint32_t>(writes.size()), writes.data(), static_cast<uint32_t>(copies.size()), copies.data());
+		clear();
+	}
+
+	void DescriptorUpdateBatch::clear()
+	{
+		writes.clear();
+		infoRefs.clear();
+		copies.clear();
+		bufferInfos.clear();
+		imageInfos.clear();
+		texelBufferViews.clear();
+	}
+
+
+
+
+
+	/// Descriptor Allocator
+	DescriptorAllocator::DescriptorAllocator() :
+		DescriptorAllocator(CreateInfo())
+	{}
+
+	DescriptorAllocator::DescriptorAllocator(const CreateInfo & createInfo) :
+		info(info_m),
+		info_m(createInfo)
+	{
+		VKW_assert(info_m.setsPerPool > 0 && info_m.growthFactor >= 1.0f, "invalid DescriptorAllocator parameters");
+	}
+
+	DescriptorPool & DescriptorAllocator::nextPool()
+	{
+		if (currentPool < pools.size()) return pools[currentPool];
+
+		uint32_t maxSets = info_m.setsPerPool;
+		if (!pools.empty()) maxSets = std::min(info_m.maxSetsPerPool, static_cast<uint32_t>(pools.back().maxSets * info_m.growthFactor));
+		maxSets = std::max(maxSets, 1u);
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		poolSizes.reserve(info_m.ratios.size());
+		for (auto & x : info_m.ratios) {
+			poolSizes.push_back({ x.type, std::max(1u, static_cast<uint32_t>(x.descriptorsPerSet * maxSets)) });
+		}
+
+		pools.emplace_back(poolSizes, maxSets, info_m.flags);
+		return pools.back();
+	}
+
+	void DescriptorAllocator::allocate(std::vector<std::reference_wrapper<DescriptorSet>> & descriptorSets, const std::vector<std::reference_wrapper<const DescriptorSetLayout>> & layouts)
+	{
+		// the sets either all come from one pool or the pool is exhausted and the next one is tried
+		for (;;) {
+			VkResult result = DescriptorSet::tryAllocateDescriptorSets(descriptorSets, nextPool(), layouts);
+
+			if (result == VK_SUCCESS) break;
+			if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+				Debug::errorCodeCheck(result, "Failed to allocate Descriptor Sets");
+				return;
+			}
+
+			if (currentPoolSets == 0) {
+				// even an empty pool can't hold the batch, smaller batches may still fit
+				if (descriptorSets.size() > 1) {
+					size_t half = descriptorSets.size() / 2;
+					std::vector<std::reference_wrapper<DescriptorSet>> first(descriptorSets.begin(), descriptorSets.begin() + half);
+					std::vector<std::reference_wrapper<DescriptorSet>> second(descriptorSets.begin() + half, descriptorSets.end());
+					allocate(first, { layouts.begin(), layouts.begin() + half });
+					allocate(second, { layouts.begin() + half, layouts.end() });
+					return;
+				}
+
+				Debug::errorCodeCheck(result, "Descriptor Set doesn't fit into an empty pool, check the pool size ratios");
+				return;
+			}
+
+			exhaustedPools++;
+			currentPool++;
+			currentPoolSets = 0;
+		}
+
+		currentPoolSets += static_cast<uint32_t>(descriptorSets.size());
+		allocatedSets += static_cast<uint32_t>(descriptorSets.size());
+		for (auto & x : layouts) {
+			for (auto & binding : x.get().layoutBindings) allocatedDescriptors += binding.second.descriptorCount;
+		}
+	}
+
+	void DescriptorAllocator::allocate(DescriptorSet & descriptorSet, const DescriptorSetLayout & layout)
+	{
+		std::vector<std::reference_wrapper<DescriptorSet>> sets = { descriptorSet };
+		allocate(sets, { std::cref(layout) });
+	}
+
+	void DescriptorAllocator::allocate(std::vector<DescriptorSet> & descriptorSets, const DescriptorSetLayout & layout)
+	{
+		if (descriptorSets.empty()) return;
+
+		std::vector<std::reference_wrapper<DescriptorSet>> sets(descriptorSets.begin(), descriptorSets.end());
+		std::vector<std::reference_wrapper<const DescriptorSetLayout>> layouts(descriptorSets.size(), std::cref(layout));
+		allocate(sets, layouts);
+	}
+
+	void DescriptorAllocator::reset()
+	{
+		for (auto & x : pools) x.resetDescriptorPool();
+
+		currentPool = 0;
+		currentPoolSets = 0;
+		allocatedSets = 0;
+		allocatedDescriptors = 0;
+	}
+
+	DescriptorAllocator::Statistics DescriptorAllocator::statistics() const
+	{
+		Statistics statistics;
+		statistics.poolCount = static_cast<uint32_t>(pools.size());
+		statistics.allocatedSets = allocatedSets;
+		statistics.allocatedDescriptors = allocatedDescriptors;
+		statistics.exhaustedPools = exhaustedPools;
+
+		for (auto & x : pools) {
+			statistics.setCapacity += x.maxSets;
+			for (auto & size : x.poolSizes) statistics.descriptorCapacity += size.descriptorCount;
+		}
+
+		if (statistics.setCapacity > 0) statistics.utilization = static_cast<float>(allocatedSets) / statistics.setCapacity;
+		return statistics;
+	}
+
+	void DescriptorAllocator::resetStatistics()
+	{
+		exhaustedPools = 0;
+	}
+
+
+
+
+
+	/// Descriptor Set Cache
+	DescriptorSetCache::DescriptorSetCache() :
+		DescriptorSetCache(CreateInfo())
+	{}
+
+	DescriptorSetCache::DescriptorSetCache(const CreateInfo & createInfo) :
+		maxUnusedFrames(maxUnusedFrames_m),
+		maxUnusedFrames_m(std::max(createInfo.maxUnusedFrames, createInfo.framesInFlight + 1)), // evicted sets are rewritten right away
+		allocator(createInfo.allocatorInfo)
+	{
+		VKW_assert(createInfo.maxUnusedFrames > createInfo.framesInFlight, "maxUnusedFrames has to be bigger than framesInFlight");
+	}
+
+	void DescriptorSetCache::buildKey(const DescriptorSetLayout & layout, const std::vector<DescriptorSet::WriteInfo> & writeInfos)
+	{
+		key.clear();
+		key.push_back(tools::handleToBits(static_cast<VkDescriptorSetLayout>(layout)));
+
+		for (auto & x : writeInfos) {
+			key.push_back(static_cast<uint64_t>(x.dstBinding) << 32 | x.dstArrayElement);
+			key.push_back(x.descriptorCount);
+
+			// the contents are part of the key, not the pointers
+			for (uint32_t i = 0; i < x.descriptorCount; i++) {
+				if (x.pBufferInfo) {
+					key.push_back(tools::handleToBits(x.pBufferInfo[i].buffer));
+					key.push_back(x.pBufferInfo[i].offset);
+					key.push_back(x.pBufferInfo[i].range);
+				}
+				else if (x.pImageInfo) {
+					key.push_back(tools::handleToBits(x.pImageInfo[i].sampler));
+					key.push_back(tools::handleToBits(x.pImageInfo[i].imageView));
+					key.push_back(x.pImageInfo[i].imageLayout);
+				}
+				else if (x.pTexelBufferView) {
+					key.push_back(tools::handleToBits(x.pTexelBufferView[i]));
+				}
+			}
+		}
+	}
+
+	VkDescriptorSet DescriptorSetCache::get(const DescriptorSetLayout & layout, const std::vector<DescriptorSet::WriteInfo> & writeInfos)
+	{
+		buildKey(layout, writeInfos);
+
+		auto it = sets.find(key);
+		if (it != sets.end()) {
+			statistics_m.hits++;
+			it->second.lastUsedFrame = frame;
+			return it->second.set;
+		}
+
+		statistics_m.misses++;
+
+		CachedSet cached;
+		cached.layout = layout;
+		cached.lastUsedFrame = frame;
+
+		auto evicted = evictedSets.find(cached.layout);
+		if (evicted != evictedSets.end() && !evicted->second.empty()) {
+			cached.set = std::move(evicted->second.back());
+			evicted->second.pop_back();
+			statistics_m.reusedSets++;
+		}
+		else {
+			allocator.allocate(cached.set, layout);
+		}
+
+		writes.clear();
+		for (auto & x : writeInfos) {
+			VkWriteDescriptorSet write = init::writeDescriptorSet();
+			write.dstSet = cached.set;
+			write.dstBinding = x.dstBinding;
+			write.dstArrayElement = x.dstArrayElement;
+			write.descriptorCount = x.descriptorCount;
+			write.descriptorType = layout.layoutBindings.at(x.dstBinding).descriptorType;
+			write.pImageInfo = x.pImageInfo;
+			write.pBufferInfo = x.pBufferInfo;
+			write.pTexelBufferView = x.pTexelBufferView;
+			writes.push_back(write);
+		}
+		vkUpdateDescriptorSets(impl::getRegistry<impl::Registry>().device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+		VkDescriptorSet set = cached.set;
+		sets.emplace(key, std::move(cached));
+		return set;
+	}
+
+	void DescriptorSetCache::nextFrame()
+	{
+		frame++;
+		if (frame <= maxUnusedFrames_m) return;
+
+		uint64_t oldestKept = frame - maxUnusedFrames_m;
+		for (auto it = sets.begin(); it != sets.end();) {
+			if (it->second.lastUsedFrame < oldestKept) {
+				evictedSets[it->second.layout].push_back(std::move(it->second.set));
+				it = sets.erase(it);
+				statistics_m.evictions++;
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
+	void DescriptorSetCache::clear()
+	{
+		sets.clear();
+		evictedSets.clear();
+		allocator.reset();
+	}
+
+	DescriptorSetCache::Statistics DescriptorSetCache::statistics() const
+	{
+		Statistics statistics = statistics_m;
+		statistics.cachedSets = sets.size();
+		return statistics;
+	}
+
+	void DescriptorSetCache::resetStatistics()
+	{
+		statistics_m = Statistics();
+	}
+
+
+
+
+
+	/// Layout Cache
+	const DescriptorSetLayout & LayoutCache::getDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding> & bindings, VkDescriptorSetLayoutCreateFlags flags)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// the order of the bindings doesn't change the layout
+		sortedBindings.assign(bindings.begin(), bindings.end());
+		std::sort(sortedBindings.begin(), sortedBindings.end(), [](const VkDescriptorSetLayoutBinding & a, const VkDescriptorSetLayoutBinding & b) { return a.binding < b.binding; });
+
+		key.clear();
+		key.push_back(flags);
+		for (auto & x : sortedBindings) {
+			key.push_back(static_cast<uint64_t>(x.binding) << 32 | x.descriptorCount);
+			key.push_back(static_cast<uint64_t>(x.descriptorType) << 32 | x.stageFlags);
+			key.push_back(x.pImmutableSamplers != nullptr);
+			if (x.pImmutableSamplers) {
+				for (uint32_t i = 0; i < x.descriptorCount; i++) key.push_back(tools::handleToBits(x.pImmutableSamplers[i]));
+			}
+		}
+
+		auto it = descriptorSetLayouts.find(key);
+		if (it != descriptorSetLayouts.end()) {
+			statistics_m.hits++;
+			return it->second;
+		}
+
+		statistics_m.misses++;
+		DescriptorSetLayout layout(sortedBindings, flags);
+		return descriptorSetLayouts.emplace(key, std::move(layout)).first->second;
+	}
+
+	const PipelineLayout & LayoutCache::getPipelineLayout(const std::vector<VkDescriptorSetLayout> & setLayouts, const std::vector<VkPushConstantRange> & pushConstants)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		key.clear();
+		key.push_back(setLayouts.size());
+		for (auto x : setLayouts) key.push_back(tools::handleToBits(x));
+		for (auto & x : pushConstants) {
+			key.push_back(x.stageFlags);
+			key.push_back(static_cast<uint64_t>(x.offset) << 32 | x.size);
+		}
+
+		auto it = pipelineLayouts.find(key);
+		if (it != pipelineLayouts.end()) {
+			statistics_m.hits++;
+			return it->second;
+		}
+
+		statistics_m.misses++;
+		PipelineLayout layout(setLayouts, pushConstants);
+		return pipelineLayouts.emplace(key, std::move(layout)).first->second;
+	}
+
+	void LayoutCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pipelineLayouts.clear();
+		descriptorSetLayouts.clear();
+	}
+
+	LayoutCache::Statistics LayoutCache::statistics() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Statistics statistics = statistics_m;
+		statistics.descriptorSetLayouts = descriptorSetLayouts.size();
+		statistics.pipelineLayouts = pipelineLayouts.size();
+		return statistics;
+	}
+
+	void LayoutCache::resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics_m = {};
+	}
+
+
+
+
+
+	/// Memory Ranges
+	bool MemoryRanges::query(VkDeviceSize size, VkDeviceSize alignment) const
+	{
+		return findFreeRange(size, alignment) != freeSizes.end();
 	}
 
 	void MemoryRanges::addMoreSize(VkDeviceSize size)
 	{	
-		if (freeRanges.empty()) {
-			if (memoryRanges.empty()) freeRanges[0] = size;
-			else freeRanges[*(memoryRanges.rbegin()->second.rbegin())] = size;
+		if (size == 0) return;
+
+		VkDeviceSize offset = size_m;
+		size_m += size;
+
+		if (!freeRanges.empty()) {
+			auto last = std::prev(freeRanges.end());
+			if (last->first + last->second == offset) { // the free range at the end grows
+				offset = last->first;
+				size += last->second;
+				eraseFreeRange(last);
+			}
 		}
-		else freeRanges.rbegin()->second += size;
+		insertFreeRange(offset, size);
 	}
 
 	VkDeviceSize MemoryRanges::add(VkDeviceSize size)
 	{
-		for (auto & x : freeRanges) {
-			if (x.second >= size) {
-				VkDeviceSize sizeBefore = x.second;
-				VkDeviceSize offsetBefore = x.first;
-				freeRanges.erase(x.first);
-				if (sizeBefore - size > 0) freeRanges[offsetBefore + size] = sizeBefore - size;
+		return addAligned(size, 1);
+	}
 
-				memoryRanges[offsetBefore]; // create std::multiset if not created already
-				memoryRanges.at(offsetBefore).insert(size);
+	VkDeviceSize MemoryRanges::addAligned(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		auto fit = findFreeRange(size, alignment);
+		if (fit == freeSizes.end()) return std::numeric_limits<VkDeviceSize>::max();
 
-				return offsetBefore;
+		VkDeviceSize offsetBefore = fit->second;
+		VkDeviceSize sizeBefore = fit->first;
+		VkDeviceSize alignedOffset = tools::alignUp(offsetBefore, alignment);
+		VkDeviceSize padding = alignedOffset - offsetBefore;
+
+		eraseFreeRange(freeRanges.find(offsetBefore));
+		if (padding > 0) insertFreeRange(offsetBefore, padding); // padding stays free so it can be used by smaller allocations
+		if (sizeBefore - padding - size > 0) insertFreeRange(alignedOffset + size, sizeBefore - padding - size);
+
+		memoryRanges[alignedOffset] = { size, 1 };
+
+		return alignedOffset;
+	}
+
+	void MemoryRanges::add(VkDeviceSize offset, VkDeviceSize size)
+	{
+		// a range that isn't in use would still be in freeRanges, it can't be referenced
+		auto it = memoryRanges.find(offset);
+		VKW_assert(it != memoryRanges.end() && it->second.size >= size, "range was not handed out by this MemoryRanges");
+		if (it != memoryRanges.end()) it->second.references++;
+	}
+
+	void MemoryRanges::remove(VkDeviceSize offset, VkDeviceSize size)
+	{
+		auto used = memoryRanges.find(offset);
+		if (used == memoryRanges.end()) return; // range was not handed out by this MemoryRanges
+		if (--used->second.references > 0) return; // range is still referenced
+
+		size = used->second.size;
+		memoryRanges.erase(used);
+
+		// coalesce with the neighbouring free ranges
+		auto next = freeRanges.find(offset + size);
+		if (next != freeRanges.end()) {
+			size += next->second;
+			eraseFreeRange(next);
+		}
+
+		auto lower = freeRanges.lower_bound(offset);
+		if (lower != freeRanges.begin()) {
+			auto previous = std::prev(lower);
+			if (previous->first + previous->second == offset) { // a free Range ends at offset
+				offset = previous->first;
+				size += previous->second;
+				eraseFreeRange(previous);
 			}
 		}
-		return std::numeric_limits<VkDeviceSize>::max();
+
+		insertFreeRange(offset, size);
 	}
 
-	void MemoryRanges::add(VkDeviceSize offset, VkDeviceSize size)
+	void MemoryRanges::reset()
+	{
+		memoryRanges.clear();
+		freeRanges.clear();
+		freeSizes.clear();
+		size_m = 0;
+		freeSize_m = 0;
+	}
+
+	VkDeviceSize MemoryRanges::totalSize() const
+	{
+		return size_m;
+	}
+
+	VkDeviceSize MemoryRanges::usedSize() const
+	{
+		return size_m - freeSize_m;
+	}
+
+	uint32_t MemoryRanges::rangeCount() const
+	{
+		return static_cast<uint32_t>(memoryRanges.size());
+	}
+
+	void MemoryRanges::insertFreeRange(VkDeviceSize offset, VkDeviceSize size)
 	{
-		memoryRanges[offset].insert(size);
+		freeRanges[offset] = size;
+		freeSizes.insert({ size, offset });
+		freeSize_m += size;
 	}
 
-	void MemoryRanges::remove(VkDeviceSize offset, VkDeviceSize size)
+	void MemoryRanges::eraseFreeRange(std::map<VkDeviceSize, VkDeviceSize>::iterator it)
 	{
-		// remove from memoryRanges
-		std::set<VkDeviceSize>::iterator it = memoryRanges.at(offset).find(size);
-		std::set<VkDeviceSize>::reverse_iterator s = memoryRanges.at(offset).rbegin();
-
-		if (*it < *memoryRanges.at(offset).rbegin() || memoryRanges.at(offset).count(size) > 1) { // *it is not the biggest size at this offset or its a duplicate
-			memoryRanges.at(offset).erase(it);
-		}
-		else {
-			memoryRanges.at(offset).erase(it);
-			if (memoryRanges.at(offset).empty()) memoryRanges.erase(offset);
-
-			// add to freeRanges
-			auto lower = freeRanges.lower_bound(offset);
-
-			if (freeRanges.count(offset + size)) {		// a free range begins at size + offset
-				freeRanges[offset] = size + freeRanges.at(offset + size);
-				freeRanges.erase(offset + size);
-			}
-			else if (lower != freeRanges.begin()) {
-				auto beg = freeRanges.begin();
-				auto previous = std::prev(lower);
-				if (previous->first + previous->second == offset)  // a free Range ends at offset
-					previous->second += size;
-				else freeRanges[offset] = size;
-			}
-			else {
-				freeRanges[offset] = size;
-			}
-		}
+		freeSizes.erase({ it->second, it->first });
+		freeSize_m -= it->second;
+		freeRanges.erase(it);
 	}
 
-	void MemoryRanges::reset()
+	std::set<std::pair<VkDeviceSize, VkDeviceSize>>::const_iterator MemoryRanges::findFreeRange(VkDeviceSize size, VkDeviceSize alignment) const
 	{
-		memoryRanges.clear();
-		freeRanges.clear();
+		// best fit: the smallest free range that can hold size
+		auto fit = freeSizes.lower_bound({ size, 0 });
+		if (fit == freeSizes.end() || alignment <= 1 || fit->second % alignment == 0) return fit;
+		if (fit->first >= size + tools::alignUp(fit->second, alignment) - fit->second) return fit;
+
+		// every range of at least size + alignment - 1 fits regardless of its offset
+		return freeSizes.lower_bound({ size + alignment - 1, 0 });
 	}
 
 
@@ -352,6 +1131,7 @@ namespace vkw {
 		memoryTypeBits(memoryTypeBits_m),
 		memoryType(memoryType_m),
 		memoryRanges(memoryRanges_m),
+		persistentlyMapped(persistentlyMapped_m),
 		memoryType_m(std::numeric_limits<uint32_t>::max()),
 		memoryTypeBits_m(std::numeric_limits<uint32_t>::max()),
 		memoryFlags_m(0)
@@ -365,6 +1145,16 @@ namespace vkw {
 		allocateMemory(allocInfo);
 	}
 
+	Memory::Memory(const Memory & rhs) : Memory()
+	{
+		*this = rhs;
+	}
+
+	Memory::Memory(Memory && rhs) noexcept : Memory()
+	{
+		*this = std::move(rhs);
+	}
+
 	Memory::Memory(VkMemoryPropertyFlags memoryFlags, VkDeviceSize size) :
 		Memory()
 	{
@@ -382,10 +1172,14 @@ namespace vkw {
 		VkMemoryAllocateInfo info = vkw::init::memoryAllocateInfo();
 		info.allocationSize = size + allocInfo.additionalSize;
 		info.memoryTypeIndex = allocInfo.memoryType == std::numeric_limits<uint32_t>::max() ? tools::findMemoryType(registry.physicalDevice.memoryProperties, memoryTypeBits, memoryFlags_m) : allocInfo.memoryType;
-		info.pNext = info.pNext;
-		Debug::errorCodeCheck(vkAllocateMemory(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to allocate Memory");
+		info.pNext = allocInfo.pNext;
+		Debug::errorCodeCheck(vkAllocateMemory(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to allocate Memory");
+
+		memoryType_m = info.memoryTypeIndex;
+		size_m = info.allocationSize;
+		memoryRanges_m.addMoreSize(info.allocationSize);
 
-		memoryRanges_m.addMoreSize(size + allocInfo.additionalSize);
+		if (allocInfo.persistentlyMapped) mapPersistent();
 
 		for (auto & x : allocInfo.buffers) bindBufferToMemory(x);
 		for (auto & x : allocInfo.images) bindImageToMemory(x);
@@ -402,9 +1196,11 @@ namespace vkw {
 		VkMemoryAllocateInfo allocInfo = vkw::init::memoryAllocateInfo();
 		allocInfo.allocationSize = size + additionalSize;
 		allocInfo.memoryTypeIndex = memoryType == std::numeric_limits<uint32_t>::max() ? tools::findMemoryType(registry.physicalDevice.memoryProperties, memoryTypeBits, memoryFlags_m) : memoryType;
-		Debug::errorCodeCheck(vkAllocateMemory(registry.device, &allocInfo, nullptr, pVkObject.createNew()), "Failed to allocate Memory");
+		Debug::errorCodeCheck(vkAllocateMemory(registry.device, &allocInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to allocate Memory");
 
-		memoryRanges_m.addMoreSize(size + additionalSize);
+		memoryType_m = allocInfo.memoryTypeIndex;
+		size_m = allocInfo.allocationSize;
+		memoryRanges_m.addMoreSize(allocInfo.allocationSize);
 
 		for (auto & x : buffers) bindBufferToMemory(x);
 		for (auto & x : images) bindImageToMemory(x);
@@ -415,22 +1211,55 @@ namespace vkw {
 		memoryFlags_m = memoryFlags;
 		memoryType_m = memoryType;
 
-		allocateMemory(buffers, images, memoryFlags);
+		allocateMemory(buffers, images, additionalSize);
+	}
+
+	Memory::~Memory()
+	{
+		registry.cancelReleases(&memoryRanges_m);
 	}
 
 	Memory & Memory::operator=(const Memory & rhs)
 	{
+		registry.cancelReleases(&memoryRanges_m); // the ranges are replaced
 		impl::Object<impl::VkwDeviceMemory>::operator=(rhs);
 		memoryMap_m = rhs.memoryMap_m;
 		memoryFlags_m = rhs.memoryFlags_m;
 		size_m = rhs.size_m;
 		memoryTypeBits_m = rhs.memoryTypeBits_m;
 		memoryType_m = rhs.memoryType_m;
-		memoryRanges_m = memoryRanges_m;
+		memoryRanges_m = rhs.memoryRanges_m;
+		persistentlyMapped_m = rhs.persistentlyMapped_m;
+		dirtyRanges_m = rhs.dirtyRanges_m;
+
+		return *this;
+	}
+
+	Memory & Memory::operator=(Memory && rhs) noexcept
+	{
+		registry.cancelReleases(&memoryRanges_m);
+		impl::Object<impl::VkwDeviceMemory>::operator=(std::move(rhs));
+		memoryMap_m = std::exchange(rhs.memoryMap_m, Mapped());
+		memoryFlags_m = rhs.memoryFlags_m;
+		size_m = std::exchange(rhs.size_m, 0);
+		memoryTypeBits_m = rhs.memoryTypeBits_m;
+		memoryType_m = rhs.memoryType_m;
+		memoryRanges_m = std::move(rhs.memoryRanges_m);
+		persistentlyMapped_m = std::exchange(rhs.persistentlyMapped_m, false);
+		dirtyRanges_m = std::move(rhs.dirtyRanges_m);
+
+		rhs.memoryRanges_m.reset();
+		rhs.dirtyRanges_m.clear();
 
 		return *this;
 	}
 
+	void Memory::releaseRange(VkDeviceSize offset, VkDeviceSize size)
+	{
+		auto release = [](void * ranges, uint64_t offset, uint64_t size) { static_cast<MemoryRanges*>(ranges)->remove(offset, size); };
+		registry.releaseDeferred(release, &memoryRanges_m, offset, size);
+	}
+
 	void Memory::setMemoryTypeBitsBuffer(Buffer & buffer)
 	{
 		memoryTypeBits_m = memoryTypeBits_m & buffer.memoryTypeBits;
@@ -447,8 +1276,9 @@ namespace vkw {
 	{
 		VKW_assert(buffer.memory == nullptr, "Buffer is already bound to memory");
 
+		buffer.offset_m = memoryRanges_m.addAligned(buffer.sizeInMemory, buffer.allignement);
+		VKW_assert(buffer.offset != std::numeric_limits<VkDeviceSize>::max(), "Not enough free space in memory to bind Buffer");
 		buffer.memory = this;
-		buffer.offset_m = memoryRanges_m.add(buffer.sizeInMemory);
 
 		Debug::errorCodeCheck(vkBindBufferMemory(registry.device, buffer, *pVkObject, buffer.offset), "Failed to bind Memory to Buffer");
 	}
@@ -457,21 +1287,32 @@ namespace vkw {
 	{
 		VKW_assert(image.memory == nullptr, "image is already bound to memory");
 
+		image.offset_m = memoryRanges_m.addAligned(image.sizeInMemory, image.allignement);
+		VKW_assert(image.offset != std::numeric_limits<VkDeviceSize>::max(), "Not enough free space in memory to bind Image");
 		image.memory = this;
-		Debug::errorCodeCheck(vkBindImageMemory(registry.device, image, *pVkObject, memoryRanges_m.add(image.sizeInMemory)), "Failed to bind Memory to Image");
+
+		Debug::errorCodeCheck(vkBindImageMemory(registry.device, image, *pVkObject, image.offset), "Failed to bind Memory to Image");
 	}
 
 	void * Memory::map(VkDeviceSize size, VkDeviceSize offset, VkMemoryMapFlags flags)
 	{
-		memoryMap_m.offset = offset;
-		memoryMap_m.size = size;
-		vkw::Debug::errorCodeCheck(vkMapMemory(registry.device, *pVkObject, offset, size, flags, &memoryMap_m.mapped), "Failed to map memory");
-		return memoryMap.mapped;
+		if (persistentlyMapped) return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memoryMap.mapped) + offset);
+
+		// the mapping is widened to atom boundaries so every range inside of it can be flushed
+		VkMappedMemoryRange range = alignedRange(offset, size == VK_WHOLE_SIZE ? size_m - offset : size);
+
+		memoryMap_m.offset = range.offset;
+		memoryMap_m.size = range.size == VK_WHOLE_SIZE ? size_m - range.offset : range.size;
+		vkw::Debug::errorCodeCheck(vkMapMemory(registry.device, *pVkObject, range.offset, range.size, flags, &memoryMap_m.mapped), "Failed to map memory");
+		return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memoryMap.mapped) + offset - memoryMap.offset);
 	}
 
 	void Memory::unMap()
 	{
 		VKW_assert(memoryMap.mapped != nullptr, "Memory is not mapped");
+		if (persistentlyMapped) return;
+
+		flushDirtyRanges();
 
 		vkUnmapMemory(registry.device, *pVkObject);
 		memoryMap_m.mapped = nullptr;
@@ -479,24 +1320,97 @@ namespace vkw {
 		memoryMap_m.size = 0;
 	}
 
+	void * Memory::mapPersistent()
+	{
+		VKW_assert(memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, "Only host visible memory can be mapped");
+
+		if (persistentlyMapped) return memoryMap.mapped;
+		if (memoryMap.mapped != nullptr) unMap();
+
+		memoryMap_m.offset = 0;
+		memoryMap_m.size = size_m;
+		vkw::Debug::errorCodeCheck(vkMapMemory(registry.device, *pVkObject, 0, VK_WHOLE_SIZE, 0, &memoryMap_m.mapped), "Failed to map memory");
+		persistentlyMapped_m = true;
+
+		return memoryMap.mapped;
+	}
+
+	void Memory::unMapPersistent()
+	{
+		persistentlyMapped_m = false;
+		if (memoryMap.mapped != nullptr) unMap();
+	}
+
 	void Memory::flush()
 	{
-		VkMappedMemoryRange mappedRange = init::mappedMemoryRange();
-		mappedRange.memory = *pVkObject;
-		mappedRange.offset = memoryMap.offset;
-		mappedRange.size = memoryMap.size;
+		VkMappedMemoryRange mappedRange = alignedRange(memoryMap.offset, memoryMap.size);
 		Debug::errorCodeCheck(vkFlushMappedMemoryRanges(registry.device, 1, &mappedRange), "Could not flush mapped memory Ranges");
+		dirtyRanges_m.clear();
 	}
 
 	void Memory::invalidate()
 	{
-		VkMappedMemoryRange mappedRange = init::mappedMemoryRange();
-		mappedRange.memory = *pVkObject;
-		mappedRange.offset = memoryMap.offset;
-		mappedRange.size = memoryMap.size;
+		VkMappedMemoryRange mappedRange = alignedRange(memoryMap.offset, memoryMap.size);
 		Debug::errorCodeCheck(vkInvalidateMappedMemoryRanges(registry.device, 1, &mappedRange), "Could not invalidate mapped memory Ranges");
 	}
 
+	void Memory::markDirty(VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (isCoherent() || size == 0) return;
+
+		VkMappedMemoryRange range = alignedRange(offset, size);
+		VkDeviceSize begin = range.offset;
+		VkDeviceSize end = range.size == VK_WHOLE_SIZE ? size_m : range.offset + range.size;
+
+		// merge with every range that overlaps or touches [begin, end)
+		auto it = dirtyRanges_m.upper_bound(begin);
+		if (it != dirtyRanges_m.begin() && std::prev(it)->second >= begin) --it;
+		while (it != dirtyRanges_m.end() && it->first <= end) {
+			begin = std::min(begin, it->first);
+			end = std::max(end, it->second);
+			it = dirtyRanges_m.erase(it);
+		}
+		dirtyRanges_m[begin] = end;
+	}
+
+	void Memory::flushDirtyRanges()
+	{
+		if (dirtyRanges_m.empty()) return;
+
+		std::vector<VkMappedMemoryRange> ranges;
+		ranges.reserve(dirtyRanges_m.size());
+		for (auto & x : dirtyRanges_m) {
+			VkMappedMemoryRange range = init::mappedMemoryRange();
+			range.memory = *pVkObject;
+			range.offset = x.first;
+			range.size = x.second == size_m ? VK_WHOLE_SIZE : x.second - x.first;
+			ranges.push_back(range);
+		}
+		Debug::errorCodeCheck(vkFlushMappedMemoryRanges(registry.device, static_cast<uint32_t>(ranges.size()), ranges.data()), "Could not flush mapped memory Ranges");
+
+		dirtyRanges_m.clear();
+	}
+
+	bool Memory::isCoherent() const
+	{
+		// the chosen type can have more properties than were asked for
+		if (memoryType_m == std::numeric_limits<uint32_t>::max()) return (memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0; // not allocated yet
+		return (registry.physicalDevice.memoryProperties.memoryTypes[memoryType_m].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+	}
+
+	VkMappedMemoryRange Memory::alignedRange(VkDeviceSize offset, VkDeviceSize size) const
+	{
+		VkDeviceSize atomSize = registry.physicalDevice.properties.limits.nonCoherentAtomSize;
+
+		VkMappedMemoryRange range = init::mappedMemoryRange();
+		range.memory = *pVkObject;
+		range.offset = tools::alignDown(offset, atomSize);
+		VkDeviceSize end = tools::alignUp(offset + size, atomSize);
+		range.size = end >= size_m ? VK_WHOLE_SIZE : end - range.offset; // the end of the allocation doesn't have to be aligned
+
+		return range;
+	}
+
 	void Memory::setFlags(VkMemoryPropertyFlags memoryFlags)
 	{
 		memoryFlags_m = memoryFlags;
@@ -511,6 +1425,90 @@ namespace vkw {
 
 
 
+	/// Memory Allocator
+	MemoryAllocator::MemoryAllocator(VkDeviceSize blockSize) :
+		blockSize(blockSize_m),
+		registry(impl::getRegistry<impl::Registry>()),
+		blockSize_m(blockSize)
+	{}
+
+	MemoryAllocator::MemoryAllocator(const CreateInfo & createInfo) : MemoryAllocator(createInfo.blockSize)
+	{}
+
+	Memory & MemoryAllocator::bindBuffer(Buffer & buffer, VkMemoryPropertyFlags memoryFlags)
+	{
+		Memory & memory = findBlock(buffer.memoryTypeBits, memoryFlags, false, buffer.sizeInMemory, buffer.allignement);
+		memory.bindBufferToMemory(buffer);
+		return memory;
+	}
+
+	Memory & MemoryAllocator::bindImage(Image & image, VkMemoryPropertyFlags memoryFlags)
+	{
+		Memory & memory = findBlock(image.memoryTypeBits, memoryFlags, image.tiling == VK_IMAGE_TILING_OPTIMAL, image.sizeInMemory, image.allignement);
+		memory.bindImageToMemory(image);
+		return memory;
+	}
+
+	void MemoryAllocator::freeEmptyBlocks()
+	{
+		for (auto & x : blocks) {
+			x.second.remove_if([](const Memory & memory) { return memory.memoryRanges.usedSize() == 0; });
+		}
+	}
+
+	MemoryAllocator::Statistics MemoryAllocator::statistics() const
+	{
+		Statistics statistics;
+		for (auto & x : blocks) addStatistics(statistics, x.second);
+		return statistics;
+	}
+
+	MemoryAllocator::Statistics MemoryAllocator::statistics(uint32_t memoryType) const
+	{
+		Statistics statistics;
+		for (uint32_t optimalTiling = 0; optimalTiling < 2; ++optimalTiling) {
+			auto it = blocks.find(memoryType << 1 | optimalTiling);
+			if (it != blocks.end()) addStatistics(statistics, it->second);
+		}
+		return statistics;
+	}
+
+	Memory & MemoryAllocator::findBlock(uint32_t memoryTypeBits, VkMemoryPropertyFlags memoryFlags, bool optimalTiling, VkDeviceSize size, VkDeviceSize alignment)
+	{
+		uint32_t memoryType = tools::findMemoryType(registry.physicalDevice.memoryProperties, memoryTypeBits, memoryFlags);
+		VKW_assert(memoryType != std::numeric_limits<uint32_t>::max(), "Failed to find suitable memory type");
+
+		std::list<Memory> & memoryBlocks = blocks[memoryType << 1 | static_cast<uint32_t>(optimalTiling)];
+		for (auto & x : memoryBlocks) {
+			if (x.memoryRanges.query(size, alignment)) return x;
+		}
+
+		// resources bigger than a block get a dedicated block
+		Memory::AllocInfo allocInfo;
+		allocInfo.memoryFlags = registry.physicalDevice.memoryProperties.memoryTypes[memoryType].propertyFlags; // blocks are shared by every request resolving to this type
+		allocInfo.memoryType = memoryType;
+		allocInfo.additionalSize = std::max(blockSize_m, size + alignment);
+		allocInfo.persistentlyMapped = (allocInfo.memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0; // blocks are shared so they are mapped once
+
+		memoryBlocks.emplace_back();
+		memoryBlocks.back().allocateMemory(allocInfo);
+
+		return memoryBlocks.back();
+	}
+
+	void MemoryAllocator::addStatistics(Statistics & statistics, const std::list<Memory> & memoryBlocks)
+	{
+		for (auto & x : memoryBlocks) {
+			statistics.blockCount++;
+			statistics.allocationCount += x.memoryRanges.rangeCount();
+			statistics.reservedSize += x.memoryRanges.totalSize();
+			statistics.usedSize += x.memoryRanges.usedSize();
+		}
+	}
+
+
+
+
 	/// Buffer
 	Buffer::Buffer():
 		sizeInMemory(sizeInMemory_m),
@@ -531,10 +1529,25 @@ namespace vkw {
 		createBuffer(usageFlags, size, sharingMode, offset, createflags);
 	}
 
-	Buffer::~Buffer(){}
+	Buffer::Buffer(const Buffer & rhs) : Buffer()
+	{
+		*this = rhs;
+	}
+
+	Buffer::Buffer(Buffer && rhs) noexcept : Buffer()
+	{
+		*this = std::move(rhs);
+	}
+
+	Buffer::~Buffer()
+	{
+		releaseMemoryRange(); // ~Base only destroys the VkBuffer
+	}
 
 	void Buffer::createBuffer(const CreateInfo & createInfo)
 	{
+		releaseMemoryRange(); // the range of the previous VkBuffer, createNew() replaces it
+
 		this->usageFlags = createInfo.usageFlags;
 		this->flags = createInfo.createflags;
 		this->sharingMode = createInfo.sharingMode;
@@ -551,7 +1564,7 @@ namespace vkw {
 		// bufferInfo.pQueueFamilyIndices = 
 		// bufferInfo.queueFamilyIndexCount = 
 
-		vkw::Debug::errorCodeCheck(vkCreateBuffer(registry.device, &bufferInfo, nullptr, pVkObject.createNew()), "Failed to create buffer");
+		vkw::Debug::errorCodeCheck(vkCreateBuffer(registry.device, &bufferInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create buffer");
 
 		VkMemoryRequirements memoryRequirements;
 		vkGetBufferMemoryRequirements(registry.device, *pVkObject, &memoryRequirements);
@@ -575,6 +1588,8 @@ namespace vkw {
 
 	Buffer & Buffer::operator=(const Buffer & rhs)
 	{
+		if (getPtr() != rhs.getPtr()) releaseMemoryRange(); // the range of the replaced buffer
+
 		impl::Object<impl::VkwBuffer>::operator=(rhs);
 		usageFlags = rhs.usageFlags;
 		flags = rhs.flags;
@@ -590,12 +1605,31 @@ namespace vkw {
 		return *this;
 	}
 
+	Buffer & Buffer::operator=(Buffer && rhs) noexcept
+	{
+		if (this != &rhs) releaseMemoryRange(); // the range of the replaced buffer
+
+		impl::Object<impl::VkwBuffer>::operator=(std::move(rhs));
+		usageFlags = rhs.usageFlags;
+		flags = rhs.flags;
+		sharingMode = rhs.sharingMode;
+
+		size_m = std::exchange(rhs.size_m, 0);
+		offset_m = std::exchange(rhs.offset_m, 0);
+		sizeInMemory_m = std::exchange(rhs.sizeInMemory_m, 0);
+		allignement_m = std::exchange(rhs.allignement_m, 0);
+		memoryBits_m = rhs.memoryBits_m;
+		memoryRanges = std::move(rhs.memoryRanges);
+		memory = std::exchange(rhs.memory, nullptr); // the range in memory now belongs to this buffer
+
+		rhs.memoryRanges.reset();
+
+		return *this;
+	}
+
 	void Buffer::destroyObject()
 	{
-		if (memory) { 
-			memory->memoryRanges_m.remove(offset, sizeInMemory);
-			memory = nullptr;
-		}
+		releaseMemoryRange();
 
 		size_m = 0;
 		offset_m = 0;
@@ -607,15 +1641,27 @@ namespace vkw {
 		pVkObject.destroyObject();
 	}
 
+	void Buffer::releaseMemoryRange()
+	{
+		// copies share the range with this buffer, only the reference that destroys the VkBuffer gives it back
+		if (memory && pVkObject.destroysObject()) memory->releaseRange(offset_m, sizeInMemory_m);
+		memory = nullptr;
+	}
+
 	void Buffer::write(const void * data, size_t sizeOfData, VkDeviceSize offset, bool leaveMapped) // offset is not relative to the bound memory block but to the start of the buffer 
 	{
 		VKW_assert(((offset + sizeOfData) <= size), "Invalid Parameters when writing to buffer");
 
 		VkDeviceSize offsetInUse = offset + this->offset;
 
+		if (memory->persistentlyMapped) { // whole memory is mapped, no driver calls needed
+			memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(memory->memoryMap.mapped) + offsetInUse), data, static_cast<size_t>(sizeOfData));
+			memory->markDirty(offsetInUse, sizeOfData);
+			return;
+		}
+
 		if (memory->memoryMap.mapped == nullptr) { // if memory is not mapped
-			memory->map(sizeOfData, offsetInUse);
-			memcpy(memory->memoryMap.mapped, data, static_cast<size_t>(sizeOfData));
+			memcpy(memory->map(sizeOfData, offsetInUse), data, static_cast<size_t>(sizeOfData));
 		}  
 		else if (memory->memoryMap.offset <= offsetInUse && 
 				memory->memoryMap.offset + memory->memoryMap.size >= offsetInUse + sizeOfData) {// if memory is mapped and encompassitates the needed area
@@ -623,14 +1669,15 @@ namespace vkw {
 		}
 		else { // if memory is mapped and does not encompassitate the needed area
 			memory->unMap();
-			memory->map(sizeOfData, offsetInUse);
-			memcpy(memory->memoryMap.mapped, data, static_cast<size_t>(sizeOfData));
+			memcpy(memory->map(sizeOfData, offsetInUse), data, static_cast<size_t>(sizeOfData));
 		} 
 
+		memory->markDirty(offsetInUse, sizeOfData);
+
 		if (leaveMapped == false) { memory->unMap(); }	
 	}
 
-	void Buffer::map(VkDeviceSize size, VkDeviceSize offset, VkMemoryMapFlags flags) { memory->map(size == VK_WHOLE_SIZE ? size_m : size, offset_m + offset, flags); }
+	void * Buffer::map(VkDeviceSize size, VkDeviceSize offset, VkMemoryMapFlags flags) { return memory->map(size == VK_WHOLE_SIZE ? size_m : size, offset_m + offset, flags); }
 
 	void Buffer::flush() { memory->flush(); }
 
@@ -638,8 +1685,18 @@ namespace vkw {
 
 	void Buffer::copyFromBuffer(VkBuffer srcBuffer, VkBufferCopy copyRegion, VkCommandPool cmdPool)
 	{
-		Fence fence(0);
+		BarrierBuilder acquire;
+		copyFromBufferAsync(srcBuffer, copyRegion, cmdPool, VK_NULL_HANDLE, {}, nullptr, &acquire).wait();
+		if (acquire.empty()) return;
+
+		CommandBuffer commandBuffer(registry.graphicsCommandPool);
+		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		acquire.record(commandBuffer);
+		TransferTicket(commandBuffer, registry.graphicsQueue, {}, &registry.fencePool()).wait(); // the release already finished, no semaphore needed
+	}
 
+	TransferTicket Buffer::copyFromBufferAsync(VkBuffer srcBuffer, VkBufferCopy copyRegion, VkCommandPool cmdPool, VkQueue queue, std::vector<VkSemaphore> signalSemaphores, FencePool * fencePool, BarrierBuilder * acquire)
+	{
 		VkCommandPool commandPool = cmdPool ?  cmdPool : registry.transferCommandPool;
 		CommandBuffer commandBuffer(commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -648,11 +1705,24 @@ namespace vkw {
 
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, *pVkObject, 1, &copyRegion);
 
-		commandBuffer.endCommandBuffer();
-		commandBuffer.submitCommandBuffer(registry.transferQueue, {}, fence);
-		fence.wait();
+		if (transfersOwnership(queue)) {
+			VKW_assert(acquire, "The copy releases the buffer to the graphics queue family, pass acquire to record the other half there");
+			if (acquire) {
+				BarrierBuilder release;
+				release.buffer(*pVkObject, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, copyRegion.dstOffset, copyRegion.size);
+				release.splitOwnershipTransfer(static_cast<uint32_t>(registry.transferQueue.family), static_cast<uint32_t>(registry.graphicsQueue.family), *acquire);
+				release.record(commandBuffer);
+			}
+		}
+
+		return TransferTicket(commandBuffer, queue == VK_NULL_HANDLE ? registry.transferQueue : queue, signalSemaphores, fencePool ? fencePool : &registry.fencePool());
+	}
 
-		commandBuffer.freeCommandBuffer();
+	bool Buffer::transfersOwnership(VkQueue queue) const
+	{
+		// a family of -1 means the registry has no such queue
+		return queue == VK_NULL_HANDLE && sharingMode == VK_SHARING_MODE_EXCLUSIVE && registry.transferQueue.family >= 0 && registry.graphicsQueue.family >= 0 &&
+			registry.transferQueue.family != registry.graphicsQueue.family;
 	}
 
 	VkDescriptorBufferInfo Buffer::bufferInfo(VkDeviceSize size, VkDeviceSize offset)
@@ -667,8 +1737,9 @@ namespace vkw {
 	SubBuffer Buffer::createSubBuffer(VkDeviceSize subBufferSize, VkDeviceSize offset)
 	{
 		VkDeviceSize realSize = subBufferSize == VK_WHOLE_SIZE ? size : subBufferSize;
-		VkDeviceSize realOffset = offset == std::numeric_limits<VkDeviceSize>::max() ? memoryRanges.add(subBufferSize) : offset;
-		return SubBuffer(realSize, realOffset, this);
+		bool tracked = offset == std::numeric_limits<VkDeviceSize>::max();
+		VkDeviceSize realOffset = tracked ? memoryRanges.add(subBufferSize) : offset;
+		return SubBuffer(realSize, realOffset, this, tracked);
 	}
 
 
@@ -707,16 +1778,18 @@ namespace vkw {
 		size_m = rhs.size_m;
 		offset_m = rhs.offset_m;
 		buffer = rhs.buffer;
+		tracked_m = rhs.tracked_m;
 
-		if (buffer) buffer->memoryRanges.add(offset, size);
+		if (buffer && tracked_m) buffer->memoryRanges.add(offset, size);
 	}
 
-	SubBuffer::SubBuffer(VkDeviceSize size, VkDeviceSize offset, Buffer * buffer):
+	SubBuffer::SubBuffer(VkDeviceSize size, VkDeviceSize offset, Buffer * buffer, bool tracked):
 		size(size_m),
 		offset(offset_m),
 		buffer(buffer),
 		offset_m(offset),
-		size_m(size)
+		size_m(size),
+		tracked_m(tracked)
 	{}
 
 	SubBuffer::~SubBuffer()
@@ -731,8 +1804,9 @@ namespace vkw {
 		size_m = rhs.size_m;
 		offset_m = rhs.offset_m;
 		buffer = rhs.buffer;
+		tracked_m = rhs.tracked_m;
 
-		buffer->memoryRanges.add(offset, size);
+		if (buffer && tracked_m) buffer->memoryRanges.add(offset, size);
 	
 		return *this;
 	}
@@ -757,13 +1831,19 @@ namespace vkw {
 		buffer->copyFromBuffer(*srcBuffer.buffer, VkBufferCopy{ srcBuffer.offset + offset, this->offset, size == VK_WHOLE_SIZE ? this->size : size }, commandPool);
 	}
 
-	void SubBuffer::map(VkDeviceSize size, VkDeviceSize offset, VkMemoryMapFlags flags) { buffer->map(size == VK_WHOLE_SIZE ? size_m : size, offset_m + offset, flags); }
+	TransferTicket SubBuffer::copyFromAsync(const SubBuffer & srcBuffer, VkDeviceSize size, VkDeviceSize offset, VkCommandPool commandPool, VkQueue queue, std::vector<VkSemaphore> signalSemaphores, FencePool * fencePool, BarrierBuilder * acquire)
+	{
+		return buffer->copyFromBufferAsync(*srcBuffer.buffer, VkBufferCopy{ srcBuffer.offset + offset, this->offset, size == VK_WHOLE_SIZE ? this->size : size }, commandPool, queue, signalSemaphores, fencePool, acquire);
+	}
+
+	void * SubBuffer::map(VkDeviceSize size, VkDeviceSize offset, VkMemoryMapFlags flags) { return buffer->map(size == VK_WHOLE_SIZE ? size_m : size, offset_m + offset, flags); }
 
 	void SubBuffer::clear()
 	{
 		if (buffer) {
-			buffer->memoryRanges.remove(offset, size);
+			if (tracked_m) buffer->memoryRanges.remove(offset, size);
 			buffer = nullptr;
+			tracked_m = false;
 		}
 	}
 
@@ -786,6 +1866,8 @@ namespace vkw {
 		layout(layout_m),
 		extent(extent_m),
 		sizeInMemory(size_m),
+		offset(offset_m),
+		allignement(allignement_m),
 		memoryTypeBits(memoryTypeBits_m)
 	{}
 
@@ -799,10 +1881,27 @@ namespace vkw {
 		createImage(extent, format, usage, imageType, flags);
 	}
 
+	Image::~Image()
+	{
+		releaseMemoryRange(); // ~Base only destroys the VkImage
+	}
+
+	Image::Image(const Image & rhs) : Image()
+	{
+		*this = rhs;
+	}
+
+	Image::Image(Image && rhs) noexcept : Image()
+	{
+		*this = std::move(rhs);
+	}
+
 	void Image::createImage(const CreateInfo & createInfo)
 	{
-		this;
+		releaseMemoryRange(); // the range of the previous VkImage, createNew() replaces it
+
 		layout_m = createInfo.initialLayout;
+		layouts_m.assign(createInfo.mipLevels * createInfo.arrayLayers, createInfo.initialLayout);
 		extent_m = createInfo.extent;
 
 		imageType = createInfo.imageType;
@@ -831,12 +1930,13 @@ namespace vkw {
 		info.initialLayout = createInfo.initialLayout;
 		info.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateImage(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Image");
+		vkw::Debug::errorCodeCheck(vkCreateImage(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Image");
 
 		VkMemoryRequirements memoryRequirements;
 		vkGetImageMemoryRequirements(registry.device, *pVkObject, &memoryRequirements);
 
 		size_m = memoryRequirements.size;
+		allignement_m = memoryRequirements.alignment;
 		memoryTypeBits_m = memoryRequirements.memoryTypeBits;
 	}
 
@@ -854,9 +1954,16 @@ namespace vkw {
 
 	Image & Image::operator=(const Image & rhs)
 	{
+		if (getPtr() != rhs.getPtr()) releaseMemoryRange(); // the range of the replaced image
+
 		impl::Object<impl::VkwImage>::operator=(rhs);
 		layout_m = rhs.layout_m;
+		layouts_m = rhs.layouts_m;
 		extent_m = rhs.extent_m;
+		size_m = rhs.size_m;
+		offset_m = rhs.offset_m;
+		allignement_m = rhs.allignement_m;
+		memoryTypeBits_m = rhs.memoryTypeBits_m;
 		memory = rhs.memory;
 		flags = rhs.flags;
 		imageType = rhs.imageType;
@@ -872,7 +1979,98 @@ namespace vkw {
 		return *this;
 	}
 
+	Image & Image::operator=(Image && rhs) noexcept
+	{
+		if (this != &rhs) releaseMemoryRange(); // the range of the replaced image
+
+		impl::Object<impl::VkwImage>::operator=(std::move(rhs));
+		layout_m = std::exchange(rhs.layout_m, VK_IMAGE_LAYOUT_UNDEFINED);
+		layouts_m = std::move(rhs.layouts_m);
+		extent_m = rhs.extent_m;
+		size_m = rhs.size_m;
+		offset_m = std::exchange(rhs.offset_m, 0);
+		allignement_m = rhs.allignement_m;
+		memoryTypeBits_m = rhs.memoryTypeBits_m;
+		memory = std::exchange(rhs.memory, nullptr); // the range in memory now belongs to this image
+		flags = rhs.flags;
+		imageType = rhs.imageType;
+		sharingMode = rhs.sharingMode;
+		samples = rhs.samples;
+		mipLevels = rhs.mipLevels;
+		arrayLayers = rhs.arrayLayers;
+		tiling = rhs.tiling;
+		format = rhs.format;
+		usage = rhs.usage;
+		familyQueueIndicies = std::move(rhs.familyQueueIndicies);
+
+		rhs.layouts_m.clear();
+
+		return *this;
+	}
+
+	void Image::destroyObject()
+	{
+		releaseMemoryRange();
+
+		offset_m = 0;
+
+		pVkObject.destroyObject();
+	}
+
+	void Image::releaseMemoryRange()
+	{
+		// copies share the range with this image, only the reference that destroys the VkImage gives it back
+		if (memory && pVkObject.destroysObject()) memory->releaseRange(offset_m, size_m);
+		memory = nullptr;
+	}
+
+	bool Image::transfersOwnership(VkQueue queue) const
+	{
+		// a family of -1 means the registry has no such queue
+		return queue == VK_NULL_HANDLE && sharingMode == VK_SHARING_MODE_EXCLUSIVE && registry.transferQueue.family >= 0 && registry.graphicsQueue.family >= 0 &&
+			registry.transferQueue.family != registry.graphicsQueue.family;
+	}
+
 	void Image::transitionImageLayout(VkImageLayout newLayout, VkImageAspectFlags aspectMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkCommandPool commandPool)
+	{
+		transitionImageLayout(newLayout, subresourceRange(aspectMask), srcStageMask, dstStageMask, commandPool);
+	}
+
+	void Image::transitionImageLayout(VkImageLayout newLayout, const VkImageSubresourceRange & range, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkCommandPool cmdPool)
+	{
+		VkCommandPool commandPool = cmdPool == VK_NULL_HANDLE ? registry.transferCommandPool : cmdPool;
+		CommandBuffer commandBuffer(commandPool);
+		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		recordLayoutTransition(commandBuffer, newLayout, range, srcStageMask, dstStageMask);
+
+		TransferTicket(commandBuffer, registry.transferQueue, {}, &registry.fencePool()).wait(); // only waits for this barrier, not the whole queue
+	}
+
+	void Image::recordLayoutTransition(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkImageAspectFlags aspectMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+	{
+		recordLayoutTransition(commandBuffer, newLayout, subresourceRange(aspectMask), srcStageMask, dstStageMask);
+	}
+
+	void Image::recordLayoutTransition(VkCommandBuffer commandBuffer, VkImageLayout newLayout, const VkImageSubresourceRange & range, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+	{
+		std::vector<VkImageMemoryBarrier> barriers = layoutBarriers(newLayout, range);
+
+		VkPipelineStageFlags srcStages = 0;
+		for (auto & x : barriers) srcStages |= tools::stageMaskOf(x.oldLayout);
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStageMask == 0 ? srcStages : srcStageMask, 
+			dstStageMask == 0 ? tools::stageMaskOf(newLayout) : dstStageMask,
+			0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data()
+		);
+	}
+
+	VkImageSubresourceRange Image::subresourceRange(VkImageAspectFlags aspectMask) const
 	{
 		VkImageSubresourceRange range = {};
 		range.aspectMask = aspectMask;
@@ -880,138 +2078,68 @@ namespace vkw {
 		range.baseMipLevel = 0;
 		range.layerCount = arrayLayers;
 		range.levelCount = mipLevels;
-		transitionImageLayout(newLayout, range, srcStageMask, dstStageMask, commandPool);
+		return range;
 	}
 
-	void Image::transitionImageLayout(VkImageLayout newLayout, const VkImageSubresourceRange & range, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkCommandPool cmdPool)
+	VkImageLayout Image::subresourceLayout(uint32_t mipLevel, uint32_t arrayLayer) const
 	{
-		Fence fence(0);
-		VkCommandPool commandPool = cmdPool == VK_NULL_HANDLE ? registry.transferCommandPool : cmdPool;
-		CommandBuffer commandBuffer(commandPool);
-		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		return layouts_m.at(arrayLayer * mipLevels + mipLevel);
+	}
 
+	std::vector<VkImageMemoryBarrier> Image::layoutBarriers(VkImageLayout newLayout, const VkImageSubresourceRange & range)
+	{
+		uint32_t levelCount = range.levelCount == VK_REMAINING_MIP_LEVELS ? mipLevels - range.baseMipLevel : range.levelCount;
+		uint32_t layerCount = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? arrayLayers - range.baseArrayLayer : range.layerCount;
+		if (layouts_m.size() != mipLevels * arrayLayers) layouts_m.assign(mipLevels * arrayLayers, layout_m);
 
 		VkImageMemoryBarrier barrier = vkw::init::imageMemoryBarrier();
-		barrier.oldLayout = this->layout;
-		barrier.newLayout = this->layout_m = newLayout;
+		barrier.newLayout = newLayout;
 		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		barrier.image = *pVkObject;
+		barrier.dstAccessMask = tools::accessMaskOf(newLayout);
 		barrier.subresourceRange = range;
 
+		std::vector<VkImageMemoryBarrier> barriers;
 
-		// Source layouts (old)
-		// Source access mask controls actions that have to be finished on the old layout
-		// before it will be transitioned to the new layout
-		switch (barrier.oldLayout)
-		{
-		case VK_IMAGE_LAYOUT_UNDEFINED:
-			// Image layout is undefined (or does not matter)
-			// Only valid as initial layout
-			// No flags required, listed only for completeness
-			barrier.srcAccessMask = 0;
-			break;
-
-		case VK_IMAGE_LAYOUT_PREINITIALIZED:
-			// Image is preinitialized
-			// Only valid as initial layout for linear images, preserves memory contents
-			// Make sure host writes have been finished
-			barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-			// Image is a color attachment
-			// Make sure any writes to the color buffer have been finished
-			barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-			// Image is a depth/stencil attachment
-			// Make sure any writes to the depth/stencil buffer have been finished
-			barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-			// Image is a transfer source 
-			// Make sure any reads from the image have been finished
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-			// Image is a transfer destination
-			// Make sure any writes to the image have been finished
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-			// Image is read by a shader
-			// Make sure any shader reads from the image have been finished
-			barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			break;
-		default:
-			// Other source layouts aren't handled (yet)
-			break;
-		}
+		// whole range is in one layout, which is the common case
+		VkImageLayout firstLayout = subresourceLayout(range.baseMipLevel, range.baseArrayLayer);
+		bool uniform = true;
+		for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layerCount && uniform; layer++)
+			for (uint32_t level = range.baseMipLevel; level < range.baseMipLevel + levelCount && uniform; level++)
+				uniform = subresourceLayout(level, layer) == firstLayout;
 
-		// Target layouts (new)
-		// Destination access mask controls the dependency for the new image layout
-		switch (barrier.newLayout)
-		{
-		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-			// Image will be used as a transfer destination
-			// Make sure any writes to the image have been finished
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-			// Image will be used as a transfer source
-			// Make sure any reads from the image have been finished
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-			// Image will be used as a color attachment
-			// Make sure any writes to the color buffer have been finished
-			barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-			// Image layout will be used as a depth/stencil attachment
-			// Make sure any writes to depth/stencil buffer have been finished
-			barrier.dstAccessMask = barrier.dstAccessMask | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-			// Image will be read in a shader (sampler, input attachment)
-			// Make sure any writes to the image have been finished
-			if (barrier.srcAccessMask == 0)
-			{
-				barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		if (uniform) {
+			barrier.oldLayout = firstLayout;
+			barrier.srcAccessMask = tools::accessMaskOf(firstLayout);
+			barriers.push_back(barrier);
+		}
+		else {
+			// one barrier per run of mip levels with the same layout in every array layer
+			for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layerCount; layer++) {
+				uint32_t level = range.baseMipLevel;
+				while (level < range.baseMipLevel + levelCount) {
+					uint32_t runStart = level;
+					VkImageLayout oldLayout = subresourceLayout(level, layer);
+					while (level < range.baseMipLevel + levelCount && subresourceLayout(level, layer) == oldLayout) level++;
+
+					barrier.oldLayout = oldLayout;
+					barrier.srcAccessMask = tools::accessMaskOf(oldLayout);
+					barrier.subresourceRange.baseMipLevel = runStart;
+					barrier.subresourceRange.levelCount = level - runStart;
+					barrier.subresourceRange.baseArrayLayer = layer;
+					barrier.subresourceRange.layerCount = 1;
+					barriers.push_back(barrier);
+				}
 			}
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			break;
-		default:
-			// Other source layouts aren't handled (yet)
-			break;
 		}
 
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			srcStageMask, dstStageMask,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
-
+		for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layerCount; layer++)
+			for (uint32_t level = range.baseMipLevel; level < range.baseMipLevel + levelCount; level++)
+				layouts_m[layer * mipLevels + level] = newLayout;
+		layout_m = layouts_m.front();
 
-		commandBuffer.endCommandBuffer();
-		commandBuffer.submitCommandBuffer(registry.transferQueue, {}, fence);
-		fence.wait();
-		vkQueueWaitIdle(registry.transferQueue);
-
-		commandBuffer.freeCommandBuffer();
-		fence.destroyObject();
+		return barriers;
 	}
 
 	//void Image::writeWithStagingBuffer(void * data, VkDeviceSize size, VkImageLayout desiredImageLayout, VkCommandPool transferPool) // this should be write(...) and should be implememntet in  class Texture2D : public : Image
@@ -1057,19 +2185,18 @@ namespace vkw {
 		//	regions.push_back(region);
 		//}
 
-		vkw::Fence fence(0);
+		copyFromImageAsync(srcImage, regions, cmdPool).wait();
+	}
+
+	TransferTicket Image::copyFromImageAsync(const Image & srcImage, const std::vector<VkImageCopy> & regions, VkCommandPool cmdPool, VkQueue queue, std::vector<VkSemaphore> signalSemaphores, FencePool * fencePool)
+	{
 		VkCommandPool commandPool = (cmdPool == VK_NULL_HANDLE) ? registry.transferCommandPool : cmdPool;
 		vkw::CommandBuffer commandBuffer(commandPool);
 		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 		vkCmdCopyImage(commandBuffer, srcImage, srcImage.layout, *pVkObject, layout, static_cast<uint32_t>(regions.size()), regions.data());
 
-		commandBuffer.endCommandBuffer();
-		commandBuffer.submitCommandBuffer(registry.transferQueue, {}, fence);
-		fence.wait();
-
-		commandBuffer.freeCommandBuffer();
-		fence.destroyObject();
+		return TransferTicket(commandBuffer, queue == VK_NULL_HANDLE ? registry.transferQueue : queue, signalSemaphores, fencePool ? fencePool : &registry.fencePool());
 	}
 
 	void Image::copyFromBuffer(const VkBuffer & srcBuffer, const std::vector<VkBufferImageCopy> & copyRegions, VkCommandPool cmdPool, VkQueue queue)
@@ -1092,19 +2219,43 @@ namespace vkw {
 		//	copyRegions.push_back(region);
 		//}
 
-		vkw::Fence fence(0);
+		BarrierBuilder acquire;
+		copyFromBufferAsync(srcBuffer, copyRegions, cmdPool, queue, {}, nullptr, &acquire).wait();
+		if (acquire.empty()) return;
+
+		vkw::CommandBuffer commandBuffer(registry.graphicsCommandPool);
+		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		acquire.record(commandBuffer);
+		TransferTicket(commandBuffer, registry.graphicsQueue, {}, &registry.fencePool()).wait(); // the release already finished, no semaphore needed
+	}
+
+	TransferTicket Image::copyFromBufferAsync(const VkBuffer & srcBuffer, const std::vector<VkBufferImageCopy> & copyRegions, VkCommandPool cmdPool, VkQueue queue, std::vector<VkSemaphore> signalSemaphores, FencePool * fencePool, BarrierBuilder * acquire)
+	{
 		VkCommandPool commandPool = cmdPool == VK_NULL_HANDLE ? registry.transferCommandPool : cmdPool;
 		vkw::CommandBuffer commandBuffer(commandPool);
 		commandBuffer.beginCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 		vkCmdCopyBufferToImage(commandBuffer, srcBuffer, *pVkObject, layout, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 
-		commandBuffer.endCommandBuffer();
-		commandBuffer.submitCommandBuffer(queue == VK_NULL_HANDLE? registry.transferQueue : queue, {}, fence);
-		fence.wait();
+		if (transfersOwnership(queue)) {
+			VKW_assert(acquire, "The copy releases the image to the graphics queue family, pass acquire to record the other half there");
+			if (acquire) {
+				BarrierBuilder release;
+				for (auto & region : copyRegions) {
+					VkImageSubresourceRange range = {};
+					range.aspectMask = region.imageSubresource.aspectMask;
+					range.baseMipLevel = region.imageSubresource.mipLevel;
+					range.levelCount = 1;
+					range.baseArrayLayer = region.imageSubresource.baseArrayLayer;
+					range.layerCount = region.imageSubresource.layerCount;
+					release.image(*pVkObject, layout, layout, range, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+				}
+				release.splitOwnershipTransfer(static_cast<uint32_t>(registry.transferQueue.family), static_cast<uint32_t>(registry.graphicsQueue.family), *acquire);
+				release.record(commandBuffer);
+			}
+		}
 
-		commandBuffer.freeCommandBuffer();
-		fence.destroyObject();
+		return TransferTicket(commandBuffer, queue == VK_NULL_HANDLE ? registry.transferQueue : queue, signalSemaphores, fencePool ? fencePool : &registry.fencePool());
 	}
 	
 
@@ -1132,7 +2283,7 @@ namespace vkw {
 		info.components = createInfo.components;
 		info.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateImageView(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create Image");
+		vkw::Debug::errorCodeCheck(vkCreateImageView(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Image");
 	}
 
 	void ImageView::createImageView(const Image & image, VkImageSubresourceRange subresource, VkImageViewType viewType, VkComponentMapping components)
@@ -1188,7 +2339,7 @@ namespace vkw {
 		samplerInfo.maxLod = createInfo.maxLod;
 		samplerInfo.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateSampler(registry.device, &samplerInfo, nullptr, pVkObject.createNew()), "Failed to create Sampler");
+		vkw::Debug::errorCodeCheck(vkCreateSampler(registry.device, &samplerInfo, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create Sampler");
 	}
 
 
@@ -1223,7 +2374,7 @@ namespace vkw {
 		info.layers = createInfo.layers;
 		info.pNext = createInfo.pNext;
 
-		vkw::Debug::errorCodeCheck(vkCreateFramebuffer(registry.device, &info, nullptr, pVkObject.createNew()), "Failed to create FrameBuffer");
+		vkw::Debug::errorCodeCheck(vkCreateFramebuffer(registry.device, &info, registry.allocationCallbacks, pVkObject.createNew()), "Failed to create FrameBuffer");
 	}
 
 	void FrameBuffer::createFrameBuffer(VkRenderPass renderPass, VkExtent2D extent, std::vector<VkImageView> attachments, uint32_t layers, VkFramebufferCreateFlags flags)
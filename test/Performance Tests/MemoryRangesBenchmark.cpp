@@ -0,0 +1,135 @@
+#pragma once
+#include "benchmark.hpp"
+#include <vulkan_wrapper.h>
+#include <random>
+
+
+// MemoryRanges as it was before the free list: first fit by walking freeRanges, sizes per offset in a multiset
+struct OldMemoryRanges {
+	bool query(VkDeviceSize size) const {
+		for (auto & x : freeRanges) {
+			if (x.second >= size) return true;
+		}
+		return false;
+	}
+
+	void addMoreSize(VkDeviceSize size) {
+		if (freeRanges.empty()) {
+			if (memoryRanges.empty()) freeRanges[0] = size;
+			else freeRanges[*(memoryRanges.rbegin()->second.rbegin())] = size;
+		}
+		else freeRanges.rbegin()->second += size;
+	}
+
+	VkDeviceSize add(VkDeviceSize size) {
+		for (auto & x : freeRanges) {
+			if (x.second >= size) {
+				VkDeviceSize sizeBefore = x.second;
+				VkDeviceSize offsetBefore = x.first;
+				freeRanges.erase(x.first);
+				if (sizeBefore - size > 0) freeRanges[offsetBefore + size] = sizeBefore - size;
+
+				memoryRanges[offsetBefore];
+				memoryRanges.at(offsetBefore).insert(size);
+
+				return offsetBefore;
+			}
+		}
+		return std::numeric_limits<VkDeviceSize>::max();
+	}
+
+	void remove(VkDeviceSize offset, VkDeviceSize size) {
+		std::set<VkDeviceSize>::iterator it = memoryRanges.at(offset).find(size);
+
+		if (*it < *memoryRanges.at(offset).rbegin() || memoryRanges.at(offset).count(size) > 1) {
+			memoryRanges.at(offset).erase(it);
+		}
+		else {
+			memoryRanges.at(offset).erase(it);
+			if (memoryRanges.at(offset).empty()) memoryRanges.erase(offset);
+
+			auto lower = freeRanges.lower_bound(offset);
+
+			if (freeRanges.count(offset + size)) {
+				freeRanges[offset] = size + freeRanges.at(offset + size);
+				freeRanges.erase(offset + size);
+			}
+			else if (lower != freeRanges.begin()) {
+				auto previous = std::prev(lower);
+				if (previous->first + previous->second == offset)
+					previous->second += size;
+				else freeRanges[offset] = size;
+			}
+			else {
+				freeRanges[offset] = size;
+			}
+		}
+	}
+
+	void reset() {
+		memoryRanges.clear();
+		freeRanges.clear();
+	}
+
+private:
+	std::map<VkDeviceSize, std::multiset<VkDeviceSize>> memoryRanges;
+	std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+};
+
+
+// fills a block with ranges of random sizes, then frees and refills half of them in random order, like a Memory shared by many short lived Buffers
+template<typename Ranges>
+uint32_t memoryRangesChurn(Ranges & ranges, const std::vector<VkDeviceSize> & sizes, const std::vector<uint32_t> & order, uint32_t rounds) {
+	VkDeviceSize totalSize = 0;
+	for (auto x : sizes) totalSize += x;
+
+	ranges.reset();
+	ranges.addMoreSize(2 * totalSize);
+
+	std::vector<VkDeviceSize> offsets(sizes.size());
+	for (size_t i = 0; i < sizes.size(); i++) offsets[i] = ranges.add(sizes[i]);
+
+	uint32_t failed = 0;
+	for (uint32_t round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < order.size() / 2; i++) {
+			if (offsets[order[i]] != std::numeric_limits<VkDeviceSize>::max()) ranges.remove(offsets[order[i]], sizes[order[i]]);
+		}
+		for (size_t i = 0; i < order.size() / 2; i++) {
+			offsets[order[i]] = ranges.add(sizes[order[i]]);
+			if (offsets[order[i]] == std::numeric_limits<VkDeviceSize>::max()) failed++;
+		}
+	}
+
+	for (size_t i = 0; i < sizes.size(); i++) {
+		if (offsets[i] != std::numeric_limits<VkDeviceSize>::max()) ranges.remove(offsets[i], sizes[i]);
+	}
+	return failed;
+}
+
+
+inline void memoryRangesBenchmark() {
+	printHeader("MemoryRanges");
+
+	for (uint32_t count : { 256u, 1024u, 4096u }) {
+		std::mt19937 generator(count);
+		std::uniform_int_distribution<VkDeviceSize> sizeDistribution(1, 64);
+
+		std::vector<VkDeviceSize> sizes(count);
+		for (auto & x : sizes) x = 256 * sizeDistribution(generator);
+		std::vector<uint32_t> order(count);
+		for (uint32_t i = 0; i < count; i++) order[i] = i;
+		std::shuffle(order.begin(), order.end(), generator);
+
+		const uint32_t rounds = 16;
+		OldMemoryRanges oldRanges;
+		vkw::MemoryRanges newRanges;
+		uint32_t oldFailed = 0, newFailed = 0;
+
+		double before = measure([&]() { oldFailed = memoryRangesChurn(oldRanges, sizes, order, rounds); });
+		double after = measure([&]() { newFailed = memoryRangesChurn(newRanges, sizes, order, rounds); });
+
+		printResult("churn, " + std::to_string(count) + " ranges", before, after);
+		if (oldFailed || newFailed) std::cout << "    failed allocations: before " << oldFailed << ", after " << newFailed << std::endl;
+		if (newRanges.usedSize() != 0 || newRanges.rangeCount() != 0) std::cout << "    MemoryRanges still in use after all ranges were removed" << std::endl;
+	}
+}
@@ -0,0 +1,199 @@
+#pragma once
+#include "benchmark.hpp"
+#include "setup.hpp"
+
+
+// VkObject, VkPointer and Base as they were before the pooled nodes: a heap node per object holding std::function deleters,
+// references tracked in a vector of back pointers, reduced to a Semaphore with VKW_DESTR_CONTRL_LAST_OBJECT_CALLS_DELETER
+namespace before {
+	class VkObject {
+	public:
+		VkObject(std::function<void(VkSemaphore)> & delf, std::function<void(void)> callback) :
+			deleterCallback(callback),
+			deleterFunc(delf)
+		{}
+
+		~VkObject() {
+			if (deleterCallback) deleterCallback();
+		}
+
+		void add(VkObject *& ref) {
+			references.push_back(&ref);
+		}
+
+		void remove(VkObject *& ref, std::function<void(VkSemaphore)> deleterf) {
+			references.erase(std::remove(references.begin(), references.end(), &ref), references.end());
+			ref = nullptr;
+
+			if (references.size() == 0) {
+				if (object != VK_NULL_HANDLE) {
+					if (deleterf) deleterf(object);
+					else if (deleterFunc) deleterFunc(object);
+				}
+				delete this;
+			}
+		}
+
+		void deleteThis(std::function<void(VkSemaphore)> deleterf) {
+			if (object != VK_NULL_HANDLE) {
+				if (deleterf) deleterf(object);
+				else if (deleterFunc) deleterFunc(object);
+				object = VK_NULL_HANDLE;
+			}
+			for (auto x : references) *x = nullptr;
+			delete this;
+		}
+
+		uint32_t referenceCount() {
+			return static_cast<uint32_t>(references.size());
+		}
+
+		VkSemaphore object = VK_NULL_HANDLE;
+	private:
+		std::function<void(void)> deleterCallback;
+		std::function<void(VkSemaphore)> deleterFunc = 0;
+		std::vector<VkObject**> references;
+	};
+
+	struct Registry {
+		Registry(VkDevice device) {
+			std::function<void(VkDevice, VkSemaphore, const VkAllocationCallbacks*)> deletef = vkDestroySemaphore;
+			semaphoreDeleter = [=](VkSemaphore obj) { deletef(device, obj, nullptr); };
+			this->device = device;
+		}
+
+		VkObject * getNew() {
+			std::function<void(VkSemaphore)> deleter = semaphoreDeleter; // getDeleter<T>() returned a copy
+			return new VkObject(deleter, std::function<void(void)>(0));
+		}
+
+		VkDevice device;
+		std::function<void(VkSemaphore)> semaphoreDeleter;
+	};
+
+	class VkPointer {
+	public:
+		VkPointer(Registry & reg, std::function<void(VkSemaphore)> deleterf) :
+			registry(reg),
+			deleterFunc(deleterf)
+		{}
+
+		VkPointer(const VkPointer & obj) :
+			registry(obj.registry),
+			pObject(obj.pObject),
+			deleterFunc(obj.deleterFunc)
+		{
+			if (!pObject) {
+				pObject = registry.getNew();
+				obj.pObject = pObject;
+				pObject->add(pObject);
+				obj.pObject->add(obj.pObject);
+			}
+			else {
+				pObject->add(pObject);
+			}
+		}
+
+		void destroyObject() {
+			if (!pObject) return;
+			if (pObject->referenceCount() <= 1) pObject->deleteThis(deleterFunc);
+			else pObject->remove(pObject, deleterFunc);
+		}
+
+		VkSemaphore * createNew() {
+			if (!pObject) {
+				pObject = registry.getNew();
+				pObject->add(pObject);
+			}
+			else {
+				destroyObject();
+				pObject = registry.getNew();
+			}
+			return &pObject->object;
+		}
+
+	private:
+		Registry & registry;
+		mutable VkObject * pObject = nullptr;
+		std::function<void(VkSemaphore)> deleterFunc;
+	};
+
+	class Semaphore {
+	public:
+		Semaphore(Registry & registry) :
+			registry(registry),
+			pVkObject(registry, std::function<void(VkSemaphore)>(0))
+		{}
+
+		Semaphore(const Semaphore & rhs) :
+			registry(rhs.registry),
+			pVkObject(rhs.pVkObject)
+		{}
+
+		~Semaphore() {
+			pVkObject.destroyObject();
+		}
+
+		void createSemaphore(VkSemaphoreCreateFlags flags = 0) {
+			VkSemaphoreCreateInfo createInfo = vkw::init::semaphoreCreateInfo();
+			createInfo.flags = flags;
+			vkw::Debug::errorCodeCheck(vkCreateSemaphore(registry.device, &createInfo, nullptr, pVkObject.createNew()), "Failed to create Semaphore");
+		}
+
+	private:
+		Registry & registry;
+		VkPointer pVkObject;
+	};
+}
+
+
+// creating and destroying includes the driver calls, copies only touch the wrapper
+inline void objectLifetimeBenchmark(const HeadlessDevice & context) {
+	printHeader("Base create/copy/destroy");
+
+	before::Registry oldRegistry(context.device);
+	const uint32_t copiesPerObject = 8;
+
+	for (uint32_t count : { 1000u, 10000u }) {
+		double before = measure([&]() {
+			std::vector<before::Semaphore> semaphores;
+			semaphores.reserve(count);
+			for (uint32_t i = 0; i < count; i++) {
+				semaphores.emplace_back(oldRegistry);
+				semaphores.back().createSemaphore();
+			}
+		});
+		double after = measure([&]() {
+			std::vector<vkw::Semaphore> semaphores;
+			semaphores.reserve(count);
+			for (uint32_t i = 0; i < count; i++) semaphores.emplace_back(VkSemaphoreCreateFlags(0));
+		});
+		printResult("create/destroy, " + std::to_string(count) + " Semaphores", before, after);
+
+		std::vector<before::Semaphore> oldSemaphores;
+		std::vector<vkw::Semaphore> newSemaphores;
+		oldSemaphores.reserve(count);
+		newSemaphores.reserve(count);
+		for (uint32_t i = 0; i < count; i++) {
+			oldSemaphores.emplace_back(oldRegistry);
+			oldSemaphores.back().createSemaphore();
+			newSemaphores.emplace_back(VkSemaphoreCreateFlags(0));
+		}
+
+		before = measure([&]() {
+			std::vector<before::Semaphore> copies;
+			copies.reserve(count * copiesPerObject);
+			for (auto & x : oldSemaphores) {
+				for (uint32_t i = 0; i < copiesPerObject; i++) copies.push_back(x);
+			}
+		});
+		after = measure([&]() {
+			std::vector<vkw::Semaphore> copies;
+			copies.reserve(count * copiesPerObject);
+			for (auto & x : newSemaphores) {
+				for (uint32_t i = 0; i < copiesPerObject; i++) copies.push_back(x);
+			}
+		});
+		printResult("copy/destroy, " + std::to_string(count * copiesPerObject) + " copies", before, after);
+	}
+}
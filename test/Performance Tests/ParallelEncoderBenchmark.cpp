@@ -0,0 +1,81 @@
+#pragma once
+#include "benchmark.hpp"
+#include "setup.hpp"
+
+
+// one color attachment and one subpass, the secondaries only need a compatible render pass to inherit
+inline vkw::RenderPass::CreateInfo encoderRenderPassCreateInfo(VkAttachmentReference & colorReference) {
+	VkAttachmentDescription colorAttachment = {};
+	colorAttachment.format = VK_FORMAT_R8G8B8A8_UNORM;
+	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorReference;
+
+	vkw::RenderPass::CreateInfo createInfo = {};
+	createInfo.attachements = { colorAttachment };
+	createInfo.subPasses = { subpass };
+	return createInfo;
+}
+
+
+// records itemCount items per encode, every item pushes a matrix and sets a scissor like a draw with per object data would
+inline void parallelEncoderBenchmark(const HeadlessDevice & context) {
+	const uint32_t itemCount = 20000;
+	const uint32_t repetitions = 5;
+	const uint32_t maxThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	VkAttachmentReference colorReference;
+	vkw::RenderPass renderPass(encoderRenderPassCreateInfo(colorReference));
+
+	VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float) };
+	vkw::PipelineLayout pipelineLayout({}, { pushConstantRange });
+
+	vkw::CommandPoolManager commandPools(context.device.graphicsQueue.family);
+
+	// the encoder records into secondaries of commandPools, primaries would make every encode invalid usage
+	if (commandPools.getCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY).level != VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
+		std::cerr << "CommandPoolManager returned a primary command buffer for VK_COMMAND_BUFFER_LEVEL_SECONDARY" << std::endl;
+		return;
+	}
+
+	std::array<float, 16> matrix = {};
+	auto record = [&](VkCommandBuffer commandBuffer, uint32_t first, uint32_t count) {
+		for (uint32_t i = first; i < first + count; i++) {
+			VkRect2D scissor = { { static_cast<int32_t>(i % 64), 0 }, { 64, 64 } };
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(matrix), matrix.data());
+		}
+	};
+
+	std::cout << std::endl << std::left << std::setw(40) << "ParallelEncoder::encode, " + std::to_string(itemCount) + " items"
+		<< std::right << std::setw(15) << "record time" << std::setw(11) << "speedup" << std::endl;
+
+	double singleThreaded = 0;
+	for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+		vkw::ParallelEncoder encoder(commandPools, threadCount);
+
+		// the pools are reset between the runs, this is not part of the record time
+		double best = std::numeric_limits<double>::max();
+		for (uint32_t i = 0; i < repetitions; i++) {
+			commandPools.nextFrame();
+			best = std::min(best, measure([&]() { encoder.encode(itemCount, renderPass, 0, VK_NULL_HANDLE, record); }, 1));
+		}
+		if (threadCount == 1) singleThreaded = best;
+
+		std::cout << std::left << std::setw(40) << std::to_string(threadCount) + (threadCount == 1 ? " thread" : " threads")
+			<< std::right << std::fixed << std::setprecision(3) << std::setw(12) << best << " ms" << std::setw(10) << singleThreaded / best << "x" << std::endl;
+	}
+
+	commandPools.nextFrame();
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+
+// best of repetitions, in milliseconds
+template<typename F>
+double measure(F && f, uint32_t repetitions = 5) {
+	double best = std::numeric_limits<double>::max();
+	for (uint32_t i = 0; i < repetitions; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		f();
+		auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+inline void printResult(const std::string & name, double before, double after) {
+	std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(12) << before << " ms" << std::setw(12) << after << " ms" << std::setw(10) << before / after << "x" << std::endl;
+}
+
+inline void printHeader(const std::string & name) {
+	std::cout << std::endl << std::left << std::setw(40) << name << std::right << std::setw(15) << "before" << std::setw(15) << "after" << std::setw(11) << "speedup" << std::endl;
+}
+
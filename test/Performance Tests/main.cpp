@@ -0,0 +1,15 @@
+#include "MemoryRangesBenchmark.cpp"
+#include "ObjectLifetimeBenchmark.cpp"
+#include "ParallelEncoderBenchmark.cpp"
+
+
+int main() {
+	memoryRangesBenchmark();
+
+	HeadlessDevice context;
+	objectLifetimeBenchmark(context);
+	parallelEncoderBenchmark(context);
+
+	getchar();
+	return 0;
+}
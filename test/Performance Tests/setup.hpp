@@ -0,0 +1,35 @@
+#pragma once
+#include <vulkan_wrapper.h>
+
+
+// instance and device without a window, validation layers are left out because they would dominate the timings
+struct HeadlessDevice {
+	vkw::Instance instance;
+	vkw::Device device;
+
+	HeadlessDevice(const VkAllocationCallbacks * allocationCallbacks = nullptr) :
+		instance(instanceCreateInfo(allocationCallbacks)),
+		device(deviceCreateInfo(instance))
+	{}
+
+	static vkw::Instance::CreateInfo instanceCreateInfo(const VkAllocationCallbacks * allocationCallbacks) {
+		vkw::Instance::CreateInfo createInfo = {};
+		createInfo.appInfo = vkw::init::applicationInfo();
+		createInfo.allocationCallbacks = allocationCallbacks;
+		return createInfo;
+	}
+
+	static vkw::Device::CreateInfo deviceCreateInfo(const vkw::Instance & instance) {
+		VKW_assert(instance.physicalDevices.size(), "failed to find GPUs with Vulkan support!");
+
+		vkw::Device::CreateInfo createInfo = {};
+		createInfo.physicalDevice = instance.physicalDevices.front();
+		for (auto & x : instance.physicalDevices) {
+			if (x.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU && x.queueFamilyTypes.graphicFamilies.size()) {
+				createInfo.physicalDevice = x;
+				break;
+			}
+		}
+		return createInfo;
+	}
+};
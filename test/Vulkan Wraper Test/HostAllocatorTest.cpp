@@ -0,0 +1,95 @@
+#pragma once
+#include <vulkan_wrapper.h>
+#include <random>
+
+
+// drives a HostAllocator through its VkAllocationCallbacks like a driver would, with mixed sizes, alignments and scopes
+// every allocation keeps a byte pattern that has to survive reallocations, the counters have to return to zero once everything is freed
+inline bool hostAllocatorTest() {
+	struct Allocation {
+		void * memory;
+		size_t size;
+		size_t alignment;
+		VkSystemAllocationScope scope;
+		uint8_t pattern;
+	};
+
+	vkw::HostAllocator allocator;
+	const VkAllocationCallbacks * callbacks = allocator;
+
+	std::mt19937 generator(20);
+	std::uniform_int_distribution<size_t> sizeDistribution(1, 8192); // blocks from the arenas and big allocations
+	std::uniform_int_distribution<uint32_t> alignmentDistribution(0, 8); // 1 to 256
+	std::uniform_int_distribution<uint32_t> scopeDistribution(0, vkw::HostAllocator::scopeCount - 1);
+	std::uniform_int_distribution<uint32_t> operationDistribution(0, 3); // 0, 1: allocate, 2: reallocate, 3: free
+
+	bool passed = true;
+	auto check = [&](bool condition, const char * msg) {
+		if (!condition && passed) std::cerr << "HostAllocator: " << msg << "\n";
+		passed = passed && condition;
+	};
+	auto aligned = [](void * memory, size_t alignment) { return memory && reinterpret_cast<uintptr_t>(memory) % alignment == 0; };
+	auto intact = [](const Allocation & x, size_t size) {
+		const uint8_t * bytes = static_cast<const uint8_t*>(x.memory);
+		return std::all_of(bytes, bytes + size, [&](uint8_t b) { return b == x.pattern; });
+	};
+
+	const uint32_t operationCount = 100000;
+	const size_t maxAllocations = 1000;
+	std::vector<Allocation> allocations;
+
+	for (uint32_t i = 0; i < operationCount && passed; i++) {
+		uint32_t operation = allocations.empty() ? 0 : allocations.size() >= maxAllocations ? 3 : operationDistribution(generator);
+
+		if (operation <= 1) {
+			Allocation x = {};
+			x.size = sizeDistribution(generator);
+			x.alignment = size_t(1) << alignmentDistribution(generator);
+			x.scope = static_cast<VkSystemAllocationScope>(scopeDistribution(generator));
+			x.pattern = static_cast<uint8_t>(i);
+			x.memory = callbacks->pfnAllocation(callbacks->pUserData, x.size, x.alignment, x.scope);
+			check(aligned(x.memory, x.alignment), "allocation is null or misaligned");
+			if (x.memory) std::memset(x.memory, x.pattern, x.size);
+			if (x.memory) allocations.push_back(x);
+			continue;
+		}
+
+		size_t index = std::uniform_int_distribution<size_t>(0, allocations.size() - 1)(generator);
+		Allocation & x = allocations[index];
+		check(intact(x, x.size), "allocation was overwritten");
+
+		if (operation == 2) {
+			size_t size = sizeDistribution(generator);
+			void * memory = callbacks->pfnReallocation(callbacks->pUserData, x.memory, size, x.alignment, x.scope);
+			check(aligned(memory, x.alignment), "reallocation is null or misaligned");
+			if (!memory) continue; // the original stays valid
+
+			x.memory = memory;
+			check(intact(x, std::min(x.size, size)), "reallocation lost the contents");
+			x.size = size;
+			std::memset(x.memory, x.pattern, x.size);
+		}
+		else {
+			callbacks->pfnFree(callbacks->pUserData, x.memory);
+			x = allocations.back();
+			allocations.pop_back();
+		}
+	}
+
+	for (auto & x : allocations) {
+		check(intact(x, x.size), "allocation was overwritten");
+		callbacks->pfnFree(callbacks->pUserData, x.memory);
+	}
+
+	for (uint32_t i = 0; i < vkw::HostAllocator::scopeCount; i++) {
+		vkw::HostAllocator::Statistics statistics = allocator.statistics(static_cast<VkSystemAllocationScope>(i));
+		check(statistics.usedSize == 0, "bytes still in use after everything was freed");
+		check(statistics.allocationCount == statistics.freeCount, "allocations and frees don't balance");
+	}
+
+	vkw::HostAllocator::Statistics total = allocator.totalStatistics();
+	std::cout << "HostAllocator test " << (passed ? "passed" : "failed") << ": " << total.allocationCount << " allocations, "
+		<< total.reallocationCount << " reallocations, " << total.freeCount << " frees, peak " << total.peakSize << " bytes, reserved " << allocator.reservedSize() << " bytes\n";
+
+	return passed;
+}
@@ -1,4 +1,5 @@
 #include "setup.hpp"
+#include "HostAllocatorTest.cpp"
 
 
 struct foo {
@@ -11,6 +12,8 @@ struct foo {
 int main() {
 	foo fff;
 
+	if (!hostAllocatorTest()) return 1;
+
 	GlfwWindow window = GlfwWindow(800, 600);
 
 	VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = vkw::init::debugUtilsMessengerCreateInfoEXT();
@@ -91,6 +94,11 @@ int main() {
 	vkw::Device device(deviceCreateInfo);
 	vkw::Swapchain swapChain(surface);
 
+	vkw::CommandPoolManager commandPools(device.graphicsQueue.family);
+	VKW_assert(commandPools.getCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY).level == VK_COMMAND_BUFFER_LEVEL_PRIMARY, "expected a primary command buffer");
+	VKW_assert(commandPools.getCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY).level == VK_COMMAND_BUFFER_LEVEL_SECONDARY, "expected a secondary command buffer");
+	commandPools.nextFrame();
+
 
 	vkw::Buffer buffer1(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 1000);
 	vkw::Buffer buffer2(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 2000);